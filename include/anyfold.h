@@ -0,0 +1,56 @@
+#ifndef _ANYFOLD_C_H_
+#define _ANYFOLD_C_H_
+
+/*
+   C API of the anyfold library (link against anyfold)
+
+   images are 3 dimensional, extents[0] is the slowest and extents[2] the
+   fastest varying axis for contiguous data; strides are given in elements (not
+   bytes) per axis and may be arbitrary (including negative), a NULL strides
+   pointer denotes contiguous row-major data
+
+   image, kernel and output are never copied: if all of them are contiguous the
+   convolve_3d kernels are used (including the box filter for uniform kernels),
+   otherwise every voxel is computed through the given strides in place
+   (cpu/view.hpp); the kernels are the multi-versioned ones of cpu/compiled.hpp
+   and the functions are reentrant, so they may be called from several threads
+   at once
+
+   as for anyfold::cpu::convolve_3d, voxels closer than half a kernel to the
+   border of the image are not written; out must not overlap src
+*/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum anyfold_status {
+  ANYFOLD_SUCCESS = 0,
+  ANYFOLD_ERROR_INVALID_ARGUMENT = 1,
+  ANYFOLD_ERROR_OUT_OF_MEMORY = 2,
+  ANYFOLD_ERROR_INTERNAL = 3
+};
+
+/* convolves the float image src with the float kernel, returns an anyfold_status */
+int anyfold_convolve_3d(const float* src, const size_t* extents, const ptrdiff_t* strides,
+			const float* kernel, const size_t* kernel_extents, const ptrdiff_t* kernel_strides,
+			float* out, const ptrdiff_t* out_strides);
+
+/* same as anyfold_convolve_3d for an unsigned 16 bit image */
+int anyfold_convolve_3d_u16(const unsigned short* src, const size_t* extents, const ptrdiff_t* strides,
+			    const float* kernel, const size_t* kernel_extents, const ptrdiff_t* kernel_strides,
+			    float* out, const ptrdiff_t* out_strides);
+
+/* human readable description of an anyfold_status */
+const char* anyfold_status_string(int status);
+
+/* instruction set level the kernels were dispatched to (generic, sse42, avx2, avx512) */
+const char* anyfold_active_isa(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ANYFOLD_C_H_ */
@@ -2,5 +2,11 @@
 #define _ANYFOLD_H_
 
 #include "cpu/convolve.hpp"
+#include "cpu/fused.hpp"
+#include "cpu/strided.hpp"
+#include "cpu/pyramid.hpp"
+#include "cpu/roi.hpp"
+#include "cpu/view.hpp"
+#include "cpu/tiled.hpp"
 
 #endif /* _ANYFOLD_H_ */
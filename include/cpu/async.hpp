@@ -0,0 +1,253 @@
+#ifndef _CPU_ASYNC_HPP_
+#define _CPU_ASYNC_HPP_
+#include <vector>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+#include <algorithm>
+#include "convolve.hpp"
+#include "fused.hpp"
+
+//not part of anyfold.hpp: requires C++11 and threads (e.g. -pthread), include it explicitly
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       runs convolve_3d on a separate thread, the extents are copied, the image,
+       kernel and output have to stay alive until the returned future is ready
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT>
+    std::future<void> convolve_3d_async(SrcIterT src_begin, ExtentT* src_extents,
+					KernIterT kernel_begin, ExtentT* kernel_extents,
+					OutIterT out_begin)
+    {
+      std::vector<ExtentT> image_shape(src_extents,src_extents+3);
+      std::vector<ExtentT> kernel_shape(kernel_extents,kernel_extents+3);
+
+      return std::async(std::launch::async,
+			[=]() mutable {
+			  convolve_3d(src_begin, &image_shape[0],
+				      kernel_begin, &kernel_shape[0],
+				      out_begin);
+			});
+    }
+
+    namespace detail {
+
+      //float frames take the full convolve_3d path (incl. the box filter for uniform kernels)
+      inline void convolve_frame(const float* _frame, long* _frame_extents,
+				 const float* _kernel, long* _kernel_extents,
+				 float* _out){
+	convolve_3d(_frame, _frame_extents, _kernel, _kernel_extents, _out);
+      }
+
+      //other pixel types (e.g. uint16 camera frames) are convolved with float weights
+      template <typename ValueT>
+      void convolve_frame(const ValueT* _frame, long* _frame_extents,
+			  const float* _kernel, long* _kernel_extents,
+			  float* _out){
+	convolve_3d_fused(_frame, _frame_extents, _kernel, _kernel_extents, _out,
+			  epilogue::identity());
+      }
+
+      /**
+	 queue that blocks consumers while it is empty, close() wakes up all
+	 consumers and makes pop return false once the queue has been drained
+      */
+      template <typename T>
+      class blocking_queue {
+
+      public:
+
+	blocking_queue():
+	  items_(),
+	  closed_(false)
+	{}
+
+	void push(const T& _item){
+	  {
+	    std::lock_guard<std::mutex> lock(mutex_);
+	    items_.push_back(_item);
+	  }
+	  not_empty_.notify_one();
+	}
+
+	bool pop(T& _item){
+	  std::unique_lock<std::mutex> lock(mutex_);
+	  not_empty_.wait(lock, [this]{ return closed_ || !items_.empty(); });
+
+	  if(items_.empty())
+	    return false;
+
+	  _item = items_.front();
+	  items_.pop_front();
+	  return true;
+	}
+
+	void close(){
+	  {
+	    std::lock_guard<std::mutex> lock(mutex_);
+	    closed_ = true;
+	  }
+	  not_empty_.notify_all();
+	}
+
+      private:
+	std::deque<T> items_;
+	bool closed_;
+	std::mutex mutex_;
+	std::condition_variable not_empty_;
+      };
+
+    };
+
+    /**
+       load -> convolve -> save pipeline for a series of frames of identical extents
+       (e.g. a time-lapse), loading frame t+1 and saving frame t-1 while frame t is
+       convolved
+
+       at most queue_depth frames wait between two stages, a stage blocks as soon as
+       all buffers of its successor are in use; the queue_depth+1 input and output
+       buffers are allocated once and reused for all frames
+
+       load(t, ValueT* frame) has to fill frame t, save(t, const float* frame) gets
+       the convolved frame t; ValueT is the pixel type of the input frames (float or
+       an integer type such as unsigned short), kernel and output are float; loading, saving and convolving run on separate
+       threads, but each stage handles frames one at a time and in order. Voxels
+       outside the valid region of convolve_3d are 0 in the saved frames. The first
+       exception thrown by any stage stops the pipeline and is rethrown by run.
+    */
+    template <typename ValueT = float>
+    class pipeline {
+
+    public:
+
+      template <typename ExtentT, typename KernIterT>
+      pipeline(const ExtentT* _frame_extents,
+	       KernIterT _kernel_begin, const ExtentT* _kernel_extents,
+	       std::size_t _queue_depth = 1):
+	frame_extents_(_frame_extents, _frame_extents + 3),
+	kernel_extents_(_kernel_extents, _kernel_extents + 3),
+	kernel_(),
+	queue_depth_(std::max(_queue_depth, std::size_t(1))),
+	inputs_(),
+	outputs_()
+      {
+	const long kernel_size = kernel_extents_[0]*kernel_extents_[1]*kernel_extents_[2];
+	kernel_.assign(_kernel_begin, _kernel_begin + kernel_size);
+
+	const long frame_size = frame_extents_[0]*frame_extents_[1]*frame_extents_[2];
+	inputs_.resize(queue_depth_ + 1, std::vector<ValueT>(frame_size));
+	outputs_.resize(queue_depth_ + 1, std::vector<float>(frame_size));
+      }
+
+      template <typename LoadT, typename SaveT>
+      void run(LoadT load, SaveT save, std::size_t num_frames){
+
+	typedef std::pair<std::size_t, std::size_t> job_t; //frame index, buffer index
+
+	detail::blocking_queue<std::size_t> free_inputs;
+	detail::blocking_queue<std::size_t> free_outputs;
+	detail::blocking_queue<job_t> loaded;
+	detail::blocking_queue<job_t> convolved;
+
+	for(std::size_t b = 0;b<inputs_.size();++b){
+	  free_inputs.push(b);
+	  free_outputs.push(b);
+	}
+
+	std::mutex error_mutex;
+	std::exception_ptr error;
+	std::atomic<bool> failed(false);
+
+	//stops all stages, only the first error is kept
+	auto abort = [&](std::exception_ptr _error){
+	  failed = true;
+	  {
+	    std::lock_guard<std::mutex> lock(error_mutex);
+	    if(!error)
+	      error = _error;
+	  }
+	  free_inputs.close();
+	  free_outputs.close();
+	  loaded.close();
+	  convolved.close();
+	};
+
+	std::future<void> loader = std::async(std::launch::async, [&]{
+	    try {
+	      std::size_t buffer = 0;
+	      for(std::size_t t = 0;t<num_frames && !failed && free_inputs.pop(buffer);++t){
+		load(t, &inputs_[buffer][0]);
+		loaded.push(job_t(t, buffer));
+	      }
+	    }
+	    catch(...){
+	      abort(std::current_exception());
+	    }
+	    loaded.close();
+	  });
+
+	std::future<void> saver = std::async(std::launch::async, [&]{
+	    try {
+	      job_t job;
+	      while(!failed && convolved.pop(job)){
+		save(job.first, const_cast<const float*>(&outputs_[job.second][0]));
+		free_outputs.push(job.second);
+	      }
+	    }
+	    catch(...){
+	      abort(std::current_exception());
+	    }
+	  });
+
+	try {
+	  job_t job;
+	  std::size_t output = 0;
+	  while(!failed && loaded.pop(job) && free_outputs.pop(output)){
+	    std::vector<float>& out = outputs_[output];
+	    std::fill(out.begin(), out.end(), 0.f);
+
+	    detail::convolve_frame(const_cast<const ValueT*>(&inputs_[job.second][0]), &frame_extents_[0],
+				   const_cast<const float*>(&kernel_[0]), &kernel_extents_[0],
+				   &out[0]);
+
+	    free_inputs.push(job.second);
+	    convolved.push(job_t(job.first, output));
+	  }
+	}
+	catch(...){
+	  abort(std::current_exception());
+	}
+	convolved.close();
+
+	loader.wait();
+	saver.wait();
+
+	if(error)
+	  std::rethrow_exception(error);
+      }
+
+      std::size_t queue_depth() const {
+	return queue_depth_;
+      }
+
+    private:
+
+      std::vector<long> frame_extents_;
+      std::vector<long> kernel_extents_;
+      std::vector<float> kernel_;
+      std::size_t queue_depth_;
+
+      std::vector<std::vector<ValueT> > inputs_;
+      std::vector<std::vector<float> > outputs_;
+    };
+
+  };
+};
+
+#endif /* _CPU_ASYNC_HPP_ */
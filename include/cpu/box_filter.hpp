@@ -0,0 +1,171 @@
+#ifndef _CPU_BOX_FILTER_HPP_
+#define _CPU_BOX_FILTER_HPP_
+#include <vector>
+#include <iterator>
+#include <numeric>
+#include <functional>
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       returns true if all weights of the kernel are identical, i.e. if the kernel
+       describes a box (or mean) filter that can be handled by box_filter_3d
+    */
+    template <typename ExtentT, typename KernIterT>
+    bool is_uniform_kernel(KernIterT kernel_begin, ExtentT* kernel_extents){
+
+      const unsigned long kernel_size = std::accumulate(kernel_extents, kernel_extents + 3, 1, std::multiplies<ExtentT>());
+      if(!kernel_size)
+	return false;
+
+      for(unsigned long i = 1;i<kernel_size;++i){
+	if(!(*(kernel_begin + i) == *kernel_begin))
+	  return false;
+      }
+
+      return true;
+    }
+
+    namespace detail {
+
+      /**
+	 sum of the input plane src_plane over every k1 x k2 window fully inside it
+	 (running sums along axis 2, then along axis 1), written to plane_sum which
+	 holds valid1*valid2 doubles; row_sums is scratch of n1*valid2 doubles
+      */
+      template <typename SrcIterT>
+      void box_plane_sum(SrcIterT src_plane, long n1, long n2, long k1, long k2,
+			 double* row_sums, double* plane_sum)
+      {
+	const long valid1 = n1 - 2*(k1/2);
+	const long valid2 = n2 - 2*(k2/2);
+
+	//running sum along axis 2
+	for(long y = 0;y<n1;++y){
+	  SrcIterT line = src_plane + y*n2;
+	  double* row = row_sums + y*valid2;
+
+	  double acc = 0.;
+	  for(long z = 0;z<k2;++z)
+	    acc += *(line + z);
+	  row[0] = acc;
+
+	  for(long z = 1;z<valid2;++z){
+	    acc += double(*(line + z + k2 - 1)) - double(*(line + z - 1));
+	    row[z] = acc;
+	  }
+	}
+
+	//running sum along axis 1
+	for(long z = 0;z<valid2;++z){
+	  double acc = 0.;
+	  for(long y = 0;y<k1;++y)
+	    acc += row_sums[y*valid2 + z];
+	  plane_sum[z] = acc;
+
+	  for(long y = 1;y<valid1;++y){
+	    acc += row_sums[(y + k1 - 1)*valid2 + z] - row_sums[(y - 1)*valid2 + z];
+	    plane_sum[y*valid2 + z] = acc;
+	  }
+	}
+      }
+
+    };
+
+    /**
+       convolves the image with a kernel of extents kernel_extents whose weights
+       are all equal to weight
+
+       the kernel is applied as a sequence of running sums along each axis,
+       accumulated in double precision, so that the cost per voxel does not depend
+       on the kernel extents; the result and the untouched border are identical to
+       what convolve_3d produces for the same (uniform) kernel, also for even
+       kernel extents
+
+       memory layout follows convolve_3d: src_extents[0] is the slowest varying axis,
+       src_extents[2] the fastest; besides the output, 4 planes of doubles are
+       allocated whatever the kernel extents (the 2D sum of the plane leaving the
+       kernel window is recomputed from the input instead of being kept around)
+    */
+    template <typename ExtentT, typename SrcIterT, typename WeightT, typename OutIterT>
+    void box_filter_3d(SrcIterT src_begin, ExtentT* src_extents,
+		       ExtentT* kernel_extents, const WeightT& weight,
+		       OutIterT out_begin)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      const long n0 = src_extents[0];
+      const long n1 = src_extents[1];
+      const long n2 = src_extents[2];
+
+      const long k0 = kernel_extents[0];
+      const long k1 = kernel_extents[1];
+      const long k2 = kernel_extents[2];
+
+      //same half kernel (and hence same valid region) as convolve_3d
+      const long h0 = k0/2;
+      const long h1 = k1/2;
+      const long h2 = k2/2;
+
+      const long valid0 = n0 - 2*h0;
+      const long valid1 = n1 - 2*h1;
+      const long valid2 = n2 - 2*h2;
+
+      if(valid0 <= 0 || valid1 <= 0 || valid2 <= 0 || k0 <= 0 || k1 <= 0 || k2 <= 0)
+	return;
+
+      const long frame_size = n1*n2;
+
+      //row sums of one input plane (along axis 2), only valid columns are stored
+      std::vector<double> row_sums(n1*valid2);
+      //2D sums of the plane entering and of the plane leaving the kernel window
+      std::vector<double> plane_sum(valid1*valid2);
+      std::vector<double> leaving_sum(valid1*valid2);
+      //running sum of the plane sums along axis 0
+      std::vector<double> volume_sums(valid1*valid2,0.);
+
+      const double scale = weight;
+
+      //the output plane x - k0 + 1 + h0 is complete once input plane x was added,
+      //for even k0 the last window ends beyond the valid region and is not written
+      const long last_x = valid0 + k0 - 2;
+
+      for(long x = 0;x<=last_x;++x){
+
+	detail::box_plane_sum(src_begin + x*frame_size, n1, n2, k1, k2,
+			      &row_sums[0], &plane_sum[0]);
+
+	for(long i = 0;i<valid1*valid2;++i)
+	  volume_sums[i] += plane_sum[i];
+
+	if(x < k0 - 1)
+	  continue;
+
+	const long out_x = x - k0 + 1 + h0;
+	OutIterT out_plane = out_begin + out_x*frame_size;
+	for(long y = 0;y<valid1;++y){
+	  OutIterT out_line = out_plane + (y + h1)*n2 + h2;
+	  const double* sums = &volume_sums[y*valid2];
+	  for(long z = 0;z<valid2;++z)
+	    *(out_line + z) = out_value_t(scale*sums[z]);
+	}
+
+	if(x == last_x)
+	  break;
+
+	//drop the plane leaving the kernel window
+	detail::box_plane_sum(src_begin + (x - k0 + 1)*frame_size, n1, n2, k1, k2,
+			      &row_sums[0], &leaving_sum[0]);
+	for(long i = 0;i<valid1*valid2;++i)
+	  volume_sums[i] -= leaving_sum[i];
+
+      }
+
+    }
+
+  };
+};
+
+#endif /* _CPU_BOX_FILTER_HPP_ */
@@ -0,0 +1,67 @@
+#ifndef _CPU_COMPILED_HPP_
+#define _CPU_COMPILED_HPP_
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       precompiled kernels of the anyfold library (link against anyfold)
+
+       every kernel is built for several instruction set levels, the best level
+       supported by the host cpu is selected when the library is loaded; the
+       environment variable ANYFOLD_ISA (generic, sse42, avx2, avx512) caps the
+       level picked at load time
+    */
+    namespace compiled {
+
+      enum isa_level {
+	isa_generic = 0,
+	isa_sse42,
+	isa_avx2,
+	isa_avx512,
+	isa_count
+      };
+
+      //name of the level as used in ANYFOLD_ISA
+      const char* isa_name(isa_level _level);
+
+      //true if the level was compiled into the library and is supported by the cpu
+      bool isa_available(isa_level _level);
+
+      //level used by the kernels below
+      isa_level active_isa();
+
+      //switches all kernels to another level, throws std::runtime_error if it is not available;
+      //must not be called while kernels are running on other threads
+      void select_isa(isa_level _level);
+
+      /**
+	 same semantics as anyfold::cpu::convolve_3d (including the box filter for
+	 uniform kernels), extents are given as {slowest, ..., fastest} axis
+      */
+      void convolve_3d(const float* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out);
+
+      void convolve_3d(const unsigned short* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out);
+
+      /**
+	 same semantics as anyfold::cpu::convolve_3d_view: image, kernel and output
+	 are addressed in place through their element strides (no box filter)
+      */
+      void convolve_3d(const float* _src, const long* _src_extents, const long* _src_strides,
+		       const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+		       float* _out, const long* _out_strides);
+
+      void convolve_3d(const unsigned short* _src, const long* _src_extents, const long* _src_strides,
+		       const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+		       float* _out, const long* _out_strides);
+
+    };
+  };
+};
+
+#endif /* _CPU_COMPILED_HPP_ */
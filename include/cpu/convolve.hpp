@@ -4,6 +4,7 @@
 #include <numeric>
 #include <functional>
 #include "image_stack_utils.h"
+#include "box_filter.hpp"
 
 namespace anyfold {
 
@@ -56,11 +57,86 @@ namespace anyfold {
 
     }
   
+    namespace detail {
+
+      /**
+	 convolution of the image with the (flipped) kernel evaluated at a single
+	 voxel (x,y,z), accumulated in ResultT; the caller has to make sure that the
+	 kernel centered at (x,y,z) lies completely inside the image
+      */
+      template <typename ResultT, typename ExtentT, typename SrcIterT, typename KernIterT>
+      ResultT weighted_sum_at(SrcIterT src_begin, const ExtentT* src_extents,
+			      KernIterT kernel_begin, const ExtentT* kernel_extents,
+			      long x, long y, long z)
+      {
+	const long n1 = src_extents[1];
+	const long n2 = src_extents[2];
+	const long k0 = kernel_extents[0];
+	const long k1 = kernel_extents[1];
+	const long k2 = kernel_extents[2];
+
+	ResultT value = 0;
+
+	for(long kernel_x = 0;kernel_x<k0;++kernel_x){
+	  for(long kernel_y = 0;kernel_y<k1;++kernel_y){
+
+	    SrcIterT image_line = src_begin + ((x - k0/2 + kernel_x)*n1 + (y - k1/2 + kernel_y))*n2 + (z - k2/2);
+	    KernIterT kernel_line = kernel_begin + ((k0 - 1 - kernel_x)*k1 + (k1 - 1 - kernel_y))*k2 + (k2 - 1);
+
+	    for(long kernel_z = 0;kernel_z<k2;++kernel_z)
+	      value += ResultT(*(kernel_line - kernel_z))*ResultT(*(image_line + kernel_z));
+	  }
+	}
+
+	return value;
+      }
+
+      /**
+	 weighted_sum_at for image and kernel stored with arbitrary element strides
+	 (voxel (x,y,z) at src_begin + x*src_strides[0] + y*src_strides[1] + z*src_strides[2],
+	 strides may be negative)
+      */
+      template <typename ResultT, typename ExtentT, typename StrideT, typename SrcIterT, typename KernIterT>
+      ResultT weighted_sum_at(SrcIterT src_begin, const StrideT* src_strides,
+			      KernIterT kernel_begin, const ExtentT* kernel_extents, const StrideT* kernel_strides,
+			      long x, long y, long z)
+      {
+	const long k0 = kernel_extents[0];
+	const long k1 = kernel_extents[1];
+	const long k2 = kernel_extents[2];
+	const long s2 = src_strides[2];
+	const long ks2 = kernel_strides[2];
+
+	ResultT value = 0;
+
+	for(long kernel_x = 0;kernel_x<k0;++kernel_x){
+	  for(long kernel_y = 0;kernel_y<k1;++kernel_y){
+
+	    SrcIterT image_line = src_begin + (x - k0/2 + kernel_x)*long(src_strides[0])
+	      + (y - k1/2 + kernel_y)*long(src_strides[1]) + (z - k2/2)*s2;
+	    KernIterT kernel_line = kernel_begin + (k0 - 1 - kernel_x)*long(kernel_strides[0])
+	      + (k1 - 1 - kernel_y)*long(kernel_strides[1]) + (k2 - 1)*ks2;
+
+	    for(long kernel_z = 0;kernel_z<k2;++kernel_z)
+	      value += ResultT(*(kernel_line - kernel_z*ks2))*ResultT(*(image_line + kernel_z*s2));
+	  }
+	}
+
+	return value;
+      }
+
+    };
+
     template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT>
     void convolve_3d(SrcIterT src_begin, ExtentT* src_extents,
 		     KernIterT kernel_begin, ExtentT* kernel_extents,
 		     OutIterT out_begin)
     {
+      //uniform kernels (mean filters) cost O(1) per voxel via running sums,
+      //at the price of 4 planes of double scratch (see box_filter_3d)
+      if(is_uniform_kernel(kernel_begin, kernel_extents))
+	return box_filter_3d(src_begin, src_extents, kernel_extents, *kernel_begin, out_begin);
+
       std::vector<ExtentT> image_shape(src_extents,src_extents+3);
       std::vector<ExtentT> kernel_shape(kernel_extents,kernel_extents+3);
       
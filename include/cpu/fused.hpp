@@ -0,0 +1,244 @@
+#ifndef _CPU_FUSED_HPP_
+#define _CPU_FUSED_HPP_
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include "convolve.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       pointwise epilogues for convolve_3d_fused
+
+       epilogues receive the convolved value(s) of one voxel as double and return
+       the value that is stored in the output; they can be chained with compose
+    */
+    namespace epilogue {
+
+      //passes the convolved value through unchanged
+      struct identity {
+	typedef double result_type;
+
+	double operator()(double _value) const {
+	  return _value;
+	}
+      };
+
+      //difference of two convolutions, e.g. difference of gaussians
+      struct difference {
+	typedef double result_type;
+
+	double operator()(double _first, double _second) const {
+	  return _first - _second;
+	}
+      };
+
+      //scale*value + offset
+      struct affine {
+	typedef double result_type;
+
+	double scale_;
+	double offset_;
+
+	affine(double _scale = 1., double _offset = 0.):
+	  scale_(_scale),
+	  offset_(_offset)
+	{}
+
+	double operator()(double _value) const {
+	  return scale_*_value + offset_;
+	}
+      };
+
+      //values below level are replaced by fill
+      struct threshold {
+	typedef double result_type;
+
+	double level_;
+	double fill_;
+
+	threshold(double _level, double _fill = 0.):
+	  level_(_level),
+	  fill_(_fill)
+	{}
+
+	double operator()(double _value) const {
+	  return _value < level_ ? fill_ : _value;
+	}
+      };
+
+      //clamps to the range of OutT (and rounds if OutT is integral)
+      template <typename OutT>
+      struct saturate_cast {
+	typedef OutT result_type;
+
+	OutT operator()(double _value) const {
+
+	  if(!std::numeric_limits<OutT>::is_integer)
+	    return OutT(_value);
+
+	  const double lowest = double(std::numeric_limits<OutT>::min());
+	  const double highest = double(std::numeric_limits<OutT>::max());
+
+	  if(!(_value > lowest))
+	    return std::numeric_limits<OutT>::min();
+	  if(!(_value < highest))
+	    return std::numeric_limits<OutT>::max();
+
+	  return OutT(std::floor(_value + .5));
+	}
+      };
+
+      //applies FirstT and then SecondT to its result
+      template <typename FirstT, typename SecondT>
+      struct composed {
+	typedef typename SecondT::result_type result_type;
+
+	FirstT first_;
+	SecondT second_;
+
+	composed(const FirstT& _first, const SecondT& _second):
+	  first_(_first),
+	  second_(_second)
+	{}
+
+	result_type operator()(double _value) const {
+	  return second_(first_(_value));
+	}
+
+	result_type operator()(double _first, double _second) const {
+	  return second_(first_(_first, _second));
+	}
+      };
+
+      template <typename FirstT, typename SecondT>
+      composed<FirstT,SecondT> compose(const FirstT& _first, const SecondT& _second){
+	return composed<FirstT,SecondT>(_first, _second);
+      }
+
+    };
+
+    /**
+       convolves the image with the kernel and stores epilogue(value) for each voxel
+       as soon as it has been computed, so that no intermediate volume is written
+
+       only every strides[i]-th voxel along axis i is computed, output voxel (i,j,k)
+       corresponds to input voxel (i*strides[0],j*strides[1],k*strides[2]) and the
+       output has decimated_extents(src_extents, strides); output voxels whose input
+       voxel lies outside the valid region of convolve_3d are not written
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT, typename EpilogueT>
+    void convolve_3d_fused(SrcIterT src_begin, ExtentT* src_extents,
+			   KernIterT kernel_begin, ExtentT* kernel_extents,
+			   OutIterT out_begin,
+			   const EpilogueT& epilogue,
+			   const ExtentT* strides)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      std::vector<long> out_extents(3);
+      std::vector<long> begin(3);
+      std::vector<long> end(3);
+      for(unsigned i = 0;i<3;++i){
+	out_extents[i] = (long(src_extents[i]) + strides[i] - 1)/strides[i];
+	//first and one past last output index whose input voxel is valid
+	begin[i] = (long(kernel_extents[i]/2) + strides[i] - 1)/strides[i];
+	end[i] = (long(src_extents[i]) - long(kernel_extents[i]/2) + strides[i] - 1)/strides[i];
+      }
+
+      for(long x = begin[0];x<end[0];++x){
+	for(long y = begin[1];y<end[1];++y){
+
+	  OutIterT out_line = out_begin + (x*out_extents[1] + y)*out_extents[2];
+
+	  for(long z = begin[2];z<end[2];++z){
+	    const double value = detail::weighted_sum_at<double>(src_begin, src_extents,
+								  kernel_begin, kernel_extents,
+								  x*strides[0], y*strides[1], z*strides[2]);
+	    *(out_line + z) = out_value_t(epilogue(value));
+	  }
+	}
+      }
+    }
+
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT, typename EpilogueT>
+    void convolve_3d_fused(SrcIterT src_begin, ExtentT* src_extents,
+			   KernIterT kernel_begin, ExtentT* kernel_extents,
+			   OutIterT out_begin,
+			   const EpilogueT& epilogue)
+    {
+      const ExtentT unit_strides[3] = {1,1,1};
+      convolve_3d_fused(src_begin, src_extents,
+			kernel_begin, kernel_extents,
+			out_begin, epilogue, unit_strides);
+    }
+
+    /**
+       convolves the image with two kernels and stores epilogue(first, second) for
+       each voxel, e.g. a difference of gaussians (with epilogue::difference) that
+       reads the input once and never materialises either convolved volume
+
+       strides behave as for the single kernel version, voxels closer to the border
+       than half of the larger kernel are not written
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OtherKernIterT,
+	      typename OutIterT, typename EpilogueT>
+    void convolve_3d_fused(SrcIterT src_begin, ExtentT* src_extents,
+			   KernIterT first_kernel_begin, ExtentT* first_kernel_extents,
+			   OtherKernIterT second_kernel_begin, ExtentT* second_kernel_extents,
+			   OutIterT out_begin,
+			   const EpilogueT& epilogue,
+			   const ExtentT* strides)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      std::vector<long> out_extents(3);
+      std::vector<long> begin(3);
+      std::vector<long> end(3);
+      for(unsigned i = 0;i<3;++i){
+	const long half_kernel = std::max(first_kernel_extents[i]/2, second_kernel_extents[i]/2);
+	out_extents[i] = (long(src_extents[i]) + strides[i] - 1)/strides[i];
+	begin[i] = (half_kernel + strides[i] - 1)/strides[i];
+	end[i] = (long(src_extents[i]) - half_kernel + strides[i] - 1)/strides[i];
+      }
+
+      for(long x = begin[0];x<end[0];++x){
+	for(long y = begin[1];y<end[1];++y){
+
+	  OutIterT out_line = out_begin + (x*out_extents[1] + y)*out_extents[2];
+
+	  for(long z = begin[2];z<end[2];++z){
+	    const double first = detail::weighted_sum_at<double>(src_begin, src_extents,
+								  first_kernel_begin, first_kernel_extents,
+								  x*strides[0], y*strides[1], z*strides[2]);
+	    const double second = detail::weighted_sum_at<double>(src_begin, src_extents,
+								   second_kernel_begin, second_kernel_extents,
+								   x*strides[0], y*strides[1], z*strides[2]);
+	    *(out_line + z) = out_value_t(epilogue(first, second));
+	  }
+	}
+      }
+    }
+
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OtherKernIterT,
+	      typename OutIterT, typename EpilogueT>
+    void convolve_3d_fused(SrcIterT src_begin, ExtentT* src_extents,
+			   KernIterT first_kernel_begin, ExtentT* first_kernel_extents,
+			   OtherKernIterT second_kernel_begin, ExtentT* second_kernel_extents,
+			   OutIterT out_begin,
+			   const EpilogueT& epilogue)
+    {
+      const ExtentT unit_strides[3] = {1,1,1};
+      convolve_3d_fused(src_begin, src_extents,
+			first_kernel_begin, first_kernel_extents,
+			second_kernel_begin, second_kernel_extents,
+			out_begin, epilogue, unit_strides);
+    }
+
+  };
+};
+
+#endif /* _CPU_FUSED_HPP_ */
@@ -0,0 +1,167 @@
+#ifndef _CPU_PYRAMID_HPP_
+#define _CPU_PYRAMID_HPP_
+#include <vector>
+#include <algorithm>
+#include "strided.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       one level of a multi-resolution pyramid, row-major like the input of
+       convolve_3d (extents_[0] is the slowest varying axis)
+    */
+    template <typename ValueT>
+    struct pyramid_level {
+
+      std::vector<long> extents_;
+      std::vector<ValueT> data_;
+
+      pyramid_level():
+	extents_(3,0),
+	data_()
+      {}
+
+      const long* extents() const {
+	return &extents_[0];
+      }
+
+      ValueT* data() {
+	return data_.empty() ? 0 : &data_[0];
+      }
+
+      const ValueT* data() const {
+	return data_.empty() ? 0 : &data_[0];
+      }
+    };
+
+    namespace detail {
+
+      /**
+	 computes plane x of a decimated level from its source level, voxels whose
+	 source voxel lies within half a kernel of the border take the value of the
+	 source voxel itself
+      */
+      template <typename SrcIterT, typename SrcExtentT, typename KernIterT, typename ExtentT, typename ValueT>
+      void decimate_plane(SrcIterT src_begin, const SrcExtentT* src_extents,
+			  KernIterT kernel_begin, const ExtentT* kernel_extents,
+			  const ExtentT* factors,
+			  pyramid_level<ValueT>& level,
+			  long x)
+      {
+	const long src_x = x*factors[0];
+	const long n1 = level.extents_[1];
+	const long n2 = level.extents_[2];
+	const long src_n1 = src_extents[1];
+	const long src_n2 = src_extents[2];
+
+	const bool plane_is_valid = src_x >= long(kernel_extents[0]/2) && src_x < long(src_extents[0] - kernel_extents[0]/2);
+
+	long src_shape[3];
+	long kernel_shape[3];
+	std::copy(src_extents, src_extents + 3, src_shape);
+	std::copy(kernel_extents, kernel_extents + 3, kernel_shape);
+
+	ValueT* out_plane = level.data() + x*n1*n2;
+	//integral levels (e.g. uint16) are rounded and clamped instead of truncated
+	const epilogue::saturate_cast<ValueT> store = epilogue::saturate_cast<ValueT>();
+
+	for(long y = 0;y<n1;++y){
+	  const long src_y = y*factors[1];
+	  const bool line_is_valid = plane_is_valid && src_y >= long(kernel_extents[1]/2) && src_y < src_n1 - long(kernel_extents[1]/2);
+
+	  for(long z = 0;z<n2;++z){
+	    const long src_z = z*factors[2];
+
+	    if(line_is_valid && src_z >= long(kernel_extents[2]/2) && src_z < src_n2 - long(kernel_extents[2]/2))
+	      out_plane[y*n2 + z] = store(weighted_sum_at<double>(src_begin, src_shape,
+								  kernel_begin, kernel_shape,
+								  src_x, src_y, src_z));
+	    else
+	      out_plane[y*n2 + z] = store(*(src_begin + (src_x*src_n1 + src_y)*src_n2 + src_z));
+	  }
+	}
+      }
+
+      //last plane of the source level that is needed to compute plane x
+      template <typename ExtentT>
+      long last_source_plane(long x, const ExtentT* kernel_extents, const ExtentT* factors, long src_n0){
+	return std::min(x*factors[0] + long(kernel_extents[0]) - 1 - long(kernel_extents[0]/2), src_n0 - 1);
+      }
+
+    };
+
+    /**
+       builds a multi-resolution pyramid of num_levels levels, level l is the
+       previous level (the input for l = 0) smoothed with the kernel and keeping only
+       every factors[i]-th voxel along axis i (see convolve_3d with strides); voxels
+       within half a kernel of the border are sampled without smoothing
+
+       all levels are produced in a single pass over the input: a plane of level
+       l+1 is computed as soon as all planes of level l it depends on are
+       available, so source planes are consumed while they are still in cache
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename ValueT>
+    void build_pyramid(SrcIterT src_begin, ExtentT* src_extents,
+		       KernIterT kernel_begin, ExtentT* kernel_extents,
+		       const ExtentT* factors,
+		       unsigned num_levels,
+		       std::vector<pyramid_level<ValueT> >& levels)
+    {
+
+      for(int d = 0;d<3;++d){
+	if(factors[d] < 1){
+	  std::ostringstream msg;
+	  msg << "[anyfold::build_pyramid]\tinvalid decimation factors found "
+	      << factors[0] << "x" << factors[1] << "x" << factors[2] << " NOT SUPPORTED\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+      }
+
+      levels.clear();
+      levels.resize(num_levels);
+
+      for(unsigned l = 0;l<num_levels;++l){
+	const long* previous = (l == 0) ? 0 : levels[l-1].extents();
+	for(unsigned i = 0;i<3;++i){
+	  const long src_extent = previous ? previous[i] : long(src_extents[i]);
+	  levels[l].extents_[i] = (src_extent + factors[i] - 1)/factors[i];
+	}
+	levels[l].data_.resize(levels[l].extents_[0]*levels[l].extents_[1]*levels[l].extents_[2]);
+      }
+
+      if(!num_levels || !levels[0].data_.size())
+	return;
+
+      //number of planes produced so far per level
+      std::vector<long> produced(num_levels,0);
+
+      for(long src_plane = 0;src_plane<long(src_extents[0]);++src_plane){
+
+	for(unsigned l = 0;l<num_levels;++l){
+
+	  const long available = (l == 0) ? src_plane : produced[l-1] - 1;
+	  const long src_n0 = (l == 0) ? long(src_extents[0]) : levels[l-1].extents_[0];
+
+	  while(produced[l] < levels[l].extents_[0] &&
+		detail::last_source_plane(produced[l], kernel_extents, factors, src_n0) <= available){
+
+	    if(l == 0)
+	      detail::decimate_plane(src_begin, src_extents,
+				     kernel_begin, kernel_extents, factors,
+				     levels[l], produced[l]);
+	    else
+	      detail::decimate_plane(levels[l-1].data(), levels[l-1].extents(),
+				     kernel_begin, kernel_extents, factors,
+				     levels[l], produced[l]);
+	    ++produced[l];
+	  }
+	}
+      }
+    }
+
+  };
+};
+
+#endif /* _CPU_PYRAMID_HPP_ */
@@ -0,0 +1,103 @@
+#ifndef _CPU_ROI_HPP_
+#define _CPU_ROI_HPP_
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include "convolve.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       convolve_3d restricted to the output box [roi_begin, roi_end) given in image
+       coordinates, out_begin has to provide (roi_end[i]-roi_begin[i]) voxels along
+       axis i (row-major like the image)
+
+       only the input voxels within half a kernel of the box are read, so the source
+       may be e.g. a memory mapped stack of which only the visible part is paged in;
+       voxels of the box outside the valid region of convolve_3d are not written
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT>
+    void convolve_3d_roi(SrcIterT src_begin, ExtentT* src_extents,
+			 KernIterT kernel_begin, ExtentT* kernel_extents,
+			 OutIterT out_begin,
+			 const ExtentT* roi_begin, const ExtentT* roi_end)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      std::vector<long> roi_extents(3);
+      std::vector<long> begin(3);
+      std::vector<long> end(3);
+      for(unsigned i = 0;i<3;++i){
+
+	if(roi_begin[i] < 0 || roi_end[i] < roi_begin[i] || roi_end[i] > src_extents[i]){
+	  std::ostringstream msg;
+	  msg << "[anyfold::convolve_3d_roi]\tregion of interest ["
+	      << roi_begin[0] << "," << roi_begin[1] << "," << roi_begin[2] << ") - ["
+	      << roi_end[0] << "," << roi_end[1] << "," << roi_end[2] << ") outside of image "
+	      << src_extents[0] << "x" << src_extents[1] << "x" << src_extents[2] << "\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+
+	roi_extents[i] = roi_end[i] - roi_begin[i];
+	begin[i] = std::max(long(roi_begin[i]), long(kernel_extents[i]/2));
+	end[i] = std::min(long(roi_end[i]), long(src_extents[i]) - long(kernel_extents[i]/2));
+      }
+
+      for(long x = begin[0];x<end[0];++x){
+	for(long y = begin[1];y<end[1];++y){
+
+	  OutIterT out_line = out_begin + ((x - roi_begin[0])*roi_extents[1] + (y - roi_begin[1]))*roi_extents[2];
+
+	  for(long z = begin[2];z<end[2];++z)
+	    *(out_line + (z - roi_begin[2])) = out_value_t(detail::weighted_sum_at<double>(src_begin, src_extents,
+									   kernel_begin, kernel_extents,
+									   x, y, z));
+	}
+      }
+    }
+
+    /**
+       convolve_3d that only computes voxels for which the mask (same extents and
+       layout as the image) is non-zero, all other voxels are not written
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename MaskIterT, typename OutIterT>
+    void convolve_3d_masked(SrcIterT src_begin, ExtentT* src_extents,
+			    KernIterT kernel_begin, ExtentT* kernel_extents,
+			    MaskIterT mask_begin,
+			    OutIterT out_begin)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      const long n0 = src_extents[0];
+      const long n1 = src_extents[1];
+      const long n2 = src_extents[2];
+
+      std::vector<long> half_kernel(3);
+      for(unsigned i = 0;i<3;++i)
+	half_kernel[i] = kernel_extents[i]/2;
+
+      for(long x = half_kernel[0];x<n0-half_kernel[0];++x){
+	for(long y = half_kernel[1];y<n1-half_kernel[1];++y){
+
+	  const long line_offset = (x*n1 + y)*n2;
+	  MaskIterT mask_line = mask_begin + line_offset;
+	  OutIterT out_line = out_begin + line_offset;
+
+	  for(long z = half_kernel[2];z<n2-half_kernel[2];++z){
+	    if(!*(mask_line + z))
+	      continue;
+
+	    *(out_line + z) = out_value_t(detail::weighted_sum_at<double>(src_begin, src_extents,
+									   kernel_begin, kernel_extents,
+									   x, y, z));
+	  }
+	}
+      }
+    }
+
+  };
+};
+
+#endif /* _CPU_ROI_HPP_ */
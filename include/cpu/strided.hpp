@@ -0,0 +1,52 @@
+#ifndef _CPU_STRIDED_HPP_
+#define _CPU_STRIDED_HPP_
+#include "fused.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       extents of an image that keeps every strides[i]-th voxel along axis i
+       (starting with the first one)
+    */
+    template <typename ExtentT, typename OutExtentT>
+    void decimated_extents(const ExtentT* src_extents, const ExtentT* strides,
+			   OutExtentT* out_extents){
+      for(unsigned i = 0;i<3;++i)
+	out_extents[i] = (src_extents[i] + strides[i] - 1)/strides[i];
+    }
+
+    /**
+       convolve_3d that only computes every strides[i]-th voxel along axis i,
+       out_begin has to provide decimated_extents(src_extents, strides) voxels
+
+       output voxel (i,j,k) is the convolution at input voxel
+       (i*strides[0],j*strides[1],k*strides[2]), output voxels whose input voxel
+       lies outside the valid region of convolve_3d are not written
+    */
+    template <typename ExtentT, typename SrcIterT, typename KernIterT, typename OutIterT>
+    void convolve_3d(SrcIterT src_begin, ExtentT* src_extents,
+		     KernIterT kernel_begin, ExtentT* kernel_extents,
+		     OutIterT out_begin,
+		     const ExtentT* strides)
+    {
+
+      for(int d = 0;d<3;++d){
+	if(strides[d] < 1){
+	  std::ostringstream msg;
+	  msg << "[anyfold::convolve_3d]\tinvalid strides found "
+	      << strides[0] << "x" << strides[1] << "x" << strides[2] << " NOT SUPPORTED\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+      }
+
+      convolve_3d_fused(src_begin, src_extents,
+			kernel_begin, kernel_extents,
+			out_begin, epilogue::identity(), strides);
+    }
+
+  };
+};
+
+#endif /* _CPU_STRIDED_HPP_ */
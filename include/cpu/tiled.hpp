@@ -0,0 +1,209 @@
+#ifndef _CPU_TILED_HPP_
+#define _CPU_TILED_HPP_
+#include <vector>
+#include <list>
+#include <map>
+#include <algorithm>
+#include "roi.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       lazily evaluated convolution of an image, split into tiles of tile_extents
+
+       a tile is computed with convolve_3d_roi the first time one of its voxels is
+       requested and kept in a cache of at most max_tiles tiles; when the cache is
+       full the least recently used tile is evicted and its buffer reused, so that
+       panning through a large (e.g. memory mapped) stack only ever convolves and
+       keeps the visible part
+
+       voxels outside the valid region of convolve_3d are 0; the image and the
+       kernel are not copied and have to outlive this object, which is not thread-safe
+    */
+    template <typename SrcIterT, typename KernIterT, typename ValueT = float>
+    class tiled_convolution {
+
+    public:
+
+      typedef ValueT value_type;
+
+      template <typename ExtentT>
+      tiled_convolution(SrcIterT _src_begin, const ExtentT* _src_extents,
+			KernIterT _kernel_begin, const ExtentT* _kernel_extents,
+			const ExtentT* _tile_extents,
+			std::size_t _max_tiles):
+	src_begin_(_src_begin),
+	kernel_begin_(_kernel_begin),
+	src_extents_(_src_extents, _src_extents + 3),
+	kernel_extents_(_kernel_extents, _kernel_extents + 3),
+	tile_extents_(_tile_extents, _tile_extents + 3),
+	num_tiles_(3),
+	max_tiles_(std::max(_max_tiles, std::size_t(1))),
+	computed_tiles_(0),
+	lru_(),
+	cache_()
+      {
+	for(int d = 0;d<3;++d){
+	  if(tile_extents_[d] < 1){
+	    std::ostringstream msg;
+	    msg << "[anyfold::tiled_convolution]\tinvalid tile extents found "
+		<< tile_extents_[0] << "x" << tile_extents_[1] << "x" << tile_extents_[2] << " NOT SUPPORTED\n";
+	    throw std::runtime_error(msg.str().c_str());
+	  }
+	  num_tiles_[d] = (src_extents_[d] + tile_extents_[d] - 1)/tile_extents_[d];
+	}
+      }
+
+      //convolved value at voxel (x,y,z) of the image, throws if (x,y,z) is outside of it
+      ValueT operator()(long x, long y, long z) {
+	if(x < 0 || x >= src_extents_[0] ||
+	   y < 0 || y >= src_extents_[1] ||
+	   z < 0 || z >= src_extents_[2]){
+	  std::ostringstream msg;
+	  msg << "[anyfold::tiled_convolution]\tvoxel (" << x << "," << y << "," << z << ") outside of image "
+	      << src_extents_[0] << "x" << src_extents_[1] << "x" << src_extents_[2] << "\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+
+	const long tx = x/tile_extents_[0];
+	const long ty = y/tile_extents_[1];
+	const long tz = z/tile_extents_[2];
+
+	const ValueT* data = tile(tx, ty, tz);
+	const long x_in_tile = x - tx*tile_extents_[0];
+	const long y_in_tile = y - ty*tile_extents_[1];
+	const long z_in_tile = z - tz*tile_extents_[2];
+
+	return data[(x_in_tile*tile_extents_[1] + y_in_tile)*tile_extents_[2] + z_in_tile];
+      }
+
+      /**
+	 convolved tile (tx,ty,tz), row-major with tile_extents() voxels; tiles at the
+	 upper end of an axis are padded with 0 if the image is not a multiple of
+	 the tile extents
+
+	 the pointer is valid until the tile is evicted, throws if (tx,ty,tz) is
+	 not a tile of the image
+      */
+      const ValueT* tile(long tx, long ty, long tz) {
+
+	if(tx < 0 || tx >= num_tiles_[0] ||
+	   ty < 0 || ty >= num_tiles_[1] ||
+	   tz < 0 || tz >= num_tiles_[2]){
+	  std::ostringstream msg;
+	  msg << "[anyfold::tiled_convolution]\ttile (" << tx << "," << ty << "," << tz << ") outside of "
+	      << num_tiles_[0] << "x" << num_tiles_[1] << "x" << num_tiles_[2] << " tiles\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+
+	const long key = (tx*num_tiles_[1] + ty)*num_tiles_[2] + tz;
+
+	typename cache_t::iterator found = cache_.find(key);
+	if(found != cache_.end()){
+	  lru_.splice(lru_.begin(), lru_, found->second.first);
+	  return &found->second.second[0];
+	}
+
+	std::vector<ValueT> buffer;
+	if(cache_.size() >= max_tiles_){
+	  typename cache_t::iterator oldest = cache_.find(lru_.back());
+	  buffer.swap(oldest->second.second);
+	  cache_.erase(oldest);
+	  lru_.pop_back();
+	}
+
+	compute_tile(tx, ty, tz, buffer);
+
+	lru_.push_front(key);
+	entry_t& entry = cache_[key];
+	entry.first = lru_.begin();
+	entry.second.swap(buffer);
+
+	return &entry.second[0];
+      }
+
+      const long* extents() const {
+	return &src_extents_[0];
+      }
+
+      const long* tile_extents() const {
+	return &tile_extents_[0];
+      }
+
+      //number of tiles currently held in the cache
+      std::size_t cached_tiles() const {
+	return cache_.size();
+      }
+
+      //number of tiles computed since construction (including recomputations)
+      std::size_t computed_tiles() const {
+	return computed_tiles_;
+      }
+
+    private:
+
+      typedef std::pair<std::list<long>::iterator, std::vector<ValueT> > entry_t;
+      typedef std::map<long, entry_t> cache_t;
+
+      void compute_tile(long tx, long ty, long tz, std::vector<ValueT>& buffer){
+
+	buffer.resize(tile_extents_[0]*tile_extents_[1]*tile_extents_[2]);
+	std::fill(buffer.begin(), buffer.end(), ValueT(0));
+
+	const long tile_index[3] = {tx, ty, tz};
+	long roi_begin[3];
+	long roi_end[3];
+	long roi_extents[3];
+	for(unsigned i = 0;i<3;++i){
+	  roi_begin[i] = tile_index[i]*tile_extents_[i];
+	  roi_end[i] = std::min(roi_begin[i] + tile_extents_[i], src_extents_[i]);
+	  roi_extents[i] = roi_end[i] - roi_begin[i];
+	}
+
+	const bool is_full_tile = std::equal(roi_extents, roi_extents + 3, tile_extents_.begin());
+
+	if(is_full_tile){
+	  convolve_3d_roi(src_begin_, &src_extents_[0],
+			  kernel_begin_, &kernel_extents_[0],
+			  buffer.begin(),
+			  roi_begin, roi_end);
+	}
+	else {
+	  std::vector<ValueT> partial(roi_extents[0]*roi_extents[1]*roi_extents[2], ValueT(0));
+	  convolve_3d_roi(src_begin_, &src_extents_[0],
+			  kernel_begin_, &kernel_extents_[0],
+			  partial.begin(),
+			  roi_begin, roi_end);
+
+	  for(long x = 0;x<roi_extents[0];++x)
+	    for(long y = 0;y<roi_extents[1];++y)
+	      std::copy(partial.begin() + (x*roi_extents[1] + y)*roi_extents[2],
+			partial.begin() + (x*roi_extents[1] + y + 1)*roi_extents[2],
+			buffer.begin() + (x*tile_extents_[1] + y)*tile_extents_[2]);
+	}
+
+	++computed_tiles_;
+      }
+
+      SrcIterT src_begin_;
+      KernIterT kernel_begin_;
+
+      std::vector<long> src_extents_;
+      std::vector<long> kernel_extents_;
+      std::vector<long> tile_extents_;
+      std::vector<long> num_tiles_;
+
+      std::size_t max_tiles_;
+      std::size_t computed_tiles_;
+
+      //most recently used tile first
+      std::list<long> lru_;
+      cache_t cache_;
+    };
+
+  };
+};
+
+#endif /* _CPU_TILED_HPP_ */
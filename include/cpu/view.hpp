@@ -0,0 +1,69 @@
+#ifndef _CPU_VIEW_HPP_
+#define _CPU_VIEW_HPP_
+#include <iterator>
+#include "convolve.hpp"
+#include "fused.hpp"
+
+namespace anyfold {
+
+  namespace cpu {
+
+    /**
+       convolve_3d_fused for image, kernel and output that are not stored
+       contiguously, e.g. transposed or sliced numpy arrays, without copying them
+
+       strides are given in elements per axis and may be negative: voxel (x,y,z) of
+       the image is src_begin[x*src_strides[0] + y*src_strides[1] + z*src_strides[2]],
+       kernel and output (which has src_extents) are addressed the same way with
+       their own strides; voxels outside the valid region of convolve_3d are not
+       written. Every voxel is computed on its own, uniform kernels do not take the
+       box filter path of convolve_3d.
+    */
+    template <typename ExtentT, typename StrideT, typename SrcIterT, typename KernIterT,
+	      typename OutIterT, typename EpilogueT>
+    void convolve_3d_view(SrcIterT src_begin, ExtentT* src_extents, const StrideT* src_strides,
+			  KernIterT kernel_begin, ExtentT* kernel_extents, const StrideT* kernel_strides,
+			  OutIterT out_begin, const StrideT* out_strides,
+			  const EpilogueT& epilogue)
+    {
+      typedef typename std::iterator_traits<OutIterT>::value_type out_value_t;
+
+      long begin[3];
+      long end[3];
+      for(unsigned i = 0;i<3;++i){
+	begin[i] = kernel_extents[i]/2;
+	end[i] = long(src_extents[i]) - long(kernel_extents[i]/2);
+      }
+
+      const long out_stride = out_strides[2];
+
+      for(long x = begin[0];x<end[0];++x){
+	for(long y = begin[1];y<end[1];++y){
+
+	  OutIterT out_line = out_begin + x*long(out_strides[0]) + y*long(out_strides[1]);
+
+	  for(long z = begin[2];z<end[2];++z){
+	    const double value = detail::weighted_sum_at<double>(src_begin, src_strides,
+								  kernel_begin, kernel_extents, kernel_strides,
+								  x, y, z);
+	    *(out_line + z*out_stride) = out_value_t(epilogue(value));
+	  }
+	}
+      }
+    }
+
+    template <typename ExtentT, typename StrideT, typename SrcIterT, typename KernIterT, typename OutIterT>
+    void convolve_3d_view(SrcIterT src_begin, ExtentT* src_extents, const StrideT* src_strides,
+			  KernIterT kernel_begin, ExtentT* kernel_extents, const StrideT* kernel_strides,
+			  OutIterT out_begin, const StrideT* out_strides)
+    {
+      convolve_3d_view(src_begin, src_extents, src_strides,
+		       kernel_begin, kernel_extents, kernel_strides,
+		       out_begin, out_strides,
+		       epilogue::identity());
+    }
+
+  };
+};
+
+#endif /* _CPU_VIEW_HPP_ */
@@ -0,0 +1,200 @@
+#ifndef _MPI_CONVOLVE_HPP_
+#define _MPI_CONVOLVE_HPP_
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <climits>
+#include <mpi.h>
+#include "../cpu/roi.hpp"
+
+namespace anyfold {
+
+  namespace mpi {
+
+    namespace detail {
+
+      template <typename ValueT>
+      struct datatype;
+
+      template <> struct datatype<float>          { static MPI_Datatype get() { return MPI_FLOAT;          } };
+      template <> struct datatype<double>         { static MPI_Datatype get() { return MPI_DOUBLE;         } };
+      template <> struct datatype<unsigned short> { static MPI_Datatype get() { return MPI_UNSIGNED_SHORT; } };
+
+      //committed contiguous datatype of count elements, freed when leaving the scope
+      struct contiguous_type {
+	MPI_Datatype type_;
+
+	contiguous_type(int _count, MPI_Datatype _element):
+	  type_(MPI_DATATYPE_NULL)
+	{
+	  MPI_Type_contiguous(_count, _element, &type_);
+	  MPI_Type_commit(&type_);
+	}
+
+	~contiguous_type(){
+	  MPI_Type_free(&type_);
+	}
+      };
+
+    };
+
+    /**
+       splits num_planes planes along the slowest varying axis into size slabs that
+       differ by at most one plane, returns first plane and number of planes of rank
+    */
+    template <typename ExtentT>
+    void slab(ExtentT num_planes, int rank, int size,
+	      ExtentT& first_plane, ExtentT& slab_planes){
+      const ExtentT base = num_planes/size;
+      const ExtentT remainder = num_planes % size;
+
+      slab_planes = base + (ExtentT(rank) < remainder ? 1 : 0);
+      first_plane = rank*base + std::min(ExtentT(rank), remainder);
+    }
+
+    /**
+       convolve_3d of an image that is distributed over the ranks of comm as
+       consecutive slabs along the slowest varying axis (axis 0), rank r holding the
+       slab following the one of rank r-1 (see slab)
+
+       every rank passes its own slab (local_extents[0] planes, local_extents[1] and
+       local_extents[2] have to agree on all ranks) and receives the matching slab
+       of the result, which is identical to running convolve_3d on the whole image;
+       the kernel_extents[0]/2 halo planes are exchanged with the neighbouring ranks
+       while the planes that do not depend on them are computed
+
+       the interior planes are computed in chunks and the halo requests are tested
+       in between, so that MPI can progress large (rendezvous) messages during the
+       computation; uniform kernels use box_filter_3d for the interior, the 2*halo
+       boundary planes are always computed voxel by voxel
+
+       every slab needs at least 2*(kernel_extents[0]/2) planes and a plane may hold
+       at most INT_MAX voxels, otherwise all ranks throw std::runtime_error; this is
+       a collective call
+    */
+    template <typename ValueT, typename ExtentT, typename KernIterT, typename OutIterT>
+    void convolve_3d(MPI_Comm comm,
+		     const ValueT* local_src, ExtentT* local_extents,
+		     KernIterT kernel_begin, ExtentT* kernel_extents,
+		     OutIterT local_out)
+    {
+      int rank = 0;
+      int size = 1;
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &size);
+
+      long src_shape[3];
+      long kernel_shape[3];
+      std::copy(local_extents, local_extents + 3, src_shape);
+      std::copy(kernel_extents, kernel_extents + 3, kernel_shape);
+
+      const long halo = kernel_shape[0]/2;
+      const long n0 = src_shape[0];
+      const long frame_size = src_shape[1]*src_shape[2];
+
+      //planes are sent as one datatype, the voxels per plane have to fit the int count
+      //(local_extents[1] and [2] agree on all ranks, so all of them throw here)
+      if(frame_size > long(INT_MAX)){
+	std::ostringstream msg;
+	msg << "[anyfold::mpi::convolve_3d]\tplanes of " << src_shape[1] << "x" << src_shape[2]
+	    << " voxels exceed the MPI count limit (" << INT_MAX << ") NOT SUPPORTED\n";
+	throw std::runtime_error(msg.str().c_str());
+      }
+
+      long thinnest = n0;
+      MPI_Allreduce(&n0, &thinnest, 1, MPI_LONG, MPI_MIN, comm);
+      if(thinnest < 2*halo){
+	std::ostringstream msg;
+	msg << "[anyfold::mpi::convolve_3d]\tslab of " << thinnest << " planes found, kernel "
+	    << kernel_shape[0] << "x" << kernel_shape[1] << "x" << kernel_shape[2]
+	    << " requires at least " << 2*halo << " planes per rank\n";
+	throw std::runtime_error(msg.str().c_str());
+      }
+
+      const bool has_lower = rank > 0 && halo > 0;
+      const bool has_upper = rank < size - 1 && halo > 0;
+
+      //halo planes of the lower neighbour followed by the first 2*halo local planes,
+      //and the last 2*halo local planes followed by the halo planes of the upper neighbour
+      std::vector<ValueT> lower(has_lower ? 3*halo*frame_size : 0);
+      std::vector<ValueT> upper(has_upper ? 3*halo*frame_size : 0);
+
+      const detail::contiguous_type plane(int(frame_size), detail::datatype<ValueT>::get());
+      const MPI_Datatype type = plane.type_;
+      const int halo_count = int(halo);
+      std::vector<MPI_Request> requests;
+      requests.reserve(4);
+
+      if(has_lower){
+	requests.push_back(MPI_Request());
+	MPI_Irecv(&lower[0], halo_count, type, rank - 1, 0, comm, &requests.back());
+	requests.push_back(MPI_Request());
+	MPI_Isend(const_cast<ValueT*>(local_src), halo_count, type, rank - 1, 1, comm, &requests.back());
+      }
+
+      if(has_upper){
+	requests.push_back(MPI_Request());
+	MPI_Irecv(&upper[2*halo*frame_size], halo_count, type, rank + 1, 1, comm, &requests.back());
+	requests.push_back(MPI_Request());
+	MPI_Isend(const_cast<ValueT*>(local_src + (n0 - halo)*frame_size), halo_count, type, rank + 1, 0, comm, &requests.back());
+      }
+
+      //interior planes only depend on local data; the box filter pays k0-1 extra
+      //planes per chunk, so its chunks are larger than the single planes of the
+      //generic path
+      const bool uniform = cpu::is_uniform_kernel(kernel_begin, kernel_shape);
+      const long chunk = uniform ? 4*kernel_shape[0] : 1;
+      int done = requests.empty();
+
+      for(long first = halo;first<n0 - halo;first += chunk){
+	const long last = std::min(first + chunk, n0 - halo);
+
+	if(uniform){
+	  //sub-volume of the planes needed for [first, last), its border planes are not written
+	  long chunk_shape[3] = {last - first + 2*halo, src_shape[1], src_shape[2]};
+	  cpu::box_filter_3d(local_src + (first - halo)*frame_size, chunk_shape,
+			     kernel_shape, *kernel_begin,
+			     local_out + (first - halo)*frame_size);
+	}
+	else {
+	  const long roi_begin[3] = {first, 0, 0};
+	  const long roi_end[3] = {last, src_shape[1], src_shape[2]};
+	  cpu::convolve_3d_roi(local_src, src_shape,
+			       kernel_begin, kernel_shape,
+			       local_out + first*frame_size,
+			       roi_begin, roi_end);
+	}
+
+	if(!done)
+	  MPI_Testall(requests.size(), &requests[0], &done, MPI_STATUSES_IGNORE);
+      }
+
+      if(!done)
+	MPI_Waitall(requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+
+      long boundary_shape[3] = {3*halo, src_shape[1], src_shape[2]};
+      const long roi_begin[3] = {halo, 0, 0};
+      const long roi_end[3] = {2*halo, src_shape[1], src_shape[2]};
+
+      if(has_lower){
+	std::copy(local_src, local_src + 2*halo*frame_size, lower.begin() + halo*frame_size);
+	cpu::convolve_3d_roi(lower.begin(), boundary_shape,
+			     kernel_begin, kernel_shape,
+			     local_out,
+			     roi_begin, roi_end);
+      }
+
+      if(has_upper){
+	std::copy(local_src + (n0 - 2*halo)*frame_size, local_src + n0*frame_size, upper.begin());
+	cpu::convolve_3d_roi(upper.begin(), boundary_shape,
+			     kernel_begin, kernel_shape,
+			     local_out + (n0 - halo)*frame_size,
+			     roi_begin, roi_end);
+      }
+    }
+
+  };
+};
+
+#endif /* _MPI_CONVOLVE_HPP_ */
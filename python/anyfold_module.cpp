@@ -0,0 +1,214 @@
+/**
+   python bindings of the anyfold C API
+
+   arrays are passed through the buffer protocol (numpy arrays, memoryviews, ...)
+   without copying them, their strides are handed to anyfold_convolve_3d as they
+   are; the GIL is released while convolving so that several python threads can
+   convolve at the same time
+*/
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include "anyfold.h"
+
+namespace {
+
+  //native, standard or little endian single character format of a buffer
+  char buffer_type(const Py_buffer& _view){
+    const char* format = _view.format ? _view.format : "B";
+    if(format[0] == '@' || format[0] == '=' || format[0] == '<')
+      ++format;
+    return (std::strlen(format) == 1) ? format[0] : '\0';
+  }
+
+  //fills extents and strides (in elements) of a 3 dimensional buffer, sets a python error otherwise
+  bool describe(const Py_buffer& _view, const char* _name, size_t* _extents, ptrdiff_t* _strides){
+
+    if(_view.ndim != 3){
+      PyErr_Format(PyExc_ValueError, "%s has to be 3 dimensional, got %d dimensions", _name, _view.ndim);
+      return false;
+    }
+
+    for(int d = 0;d<3;++d){
+      if(_view.strides[d] % _view.itemsize){
+	PyErr_Format(PyExc_ValueError, "%s has strides that are not a multiple of its item size", _name);
+	return false;
+      }
+      _extents[d] = _view.shape[d];
+      _strides[d] = _view.strides[d]/_view.itemsize;
+    }
+
+    return true;
+  }
+
+  //first and one past the last byte a buffer spans (strides may be negative)
+  void byte_range(const Py_buffer& _view, const char** _first, const char** _last){
+    *_first = static_cast<const char*>(_view.buf);
+    *_last = *_first;
+
+    for(int d = 0;d<_view.ndim;++d){
+      if(_view.shape[d] == 0){
+	*_last = *_first;
+	return;
+      }
+      const Py_ssize_t span = (_view.shape[d] - 1)*_view.strides[d];
+      if(span < 0)
+	*_first += span;
+      else
+	*_last += span;
+    }
+
+    *_last += _view.itemsize;
+  }
+
+  //true if both buffers share at least one byte
+  bool overlap(const Py_buffer& _a, const Py_buffer& _b){
+    const char* a_first = 0;
+    const char* a_last = 0;
+    const char* b_first = 0;
+    const char* b_last = 0;
+    byte_range(_a, &a_first, &a_last);
+    byte_range(_b, &b_first, &b_last);
+
+    return a_first < a_last && b_first < b_last &&
+      a_first < b_last && b_first < a_last;
+  }
+
+  //releases all acquired buffers when leaving the scope
+  struct buffers {
+    Py_buffer views_[3];
+    int acquired_;
+
+    buffers():
+      acquired_(0)
+    {}
+
+    bool acquire(PyObject* _object, int _flags){
+      if(PyObject_GetBuffer(_object, &views_[acquired_], _flags) != 0)
+	return false;
+      ++acquired_;
+      return true;
+    }
+
+    Py_buffer& operator[](int _index){
+      return views_[_index];
+    }
+
+    ~buffers(){
+      for(int i = 0;i<acquired_;++i)
+	PyBuffer_Release(&views_[i]);
+    }
+  };
+
+  const char convolve_3d_doc[] =
+    "convolve_3d(src, kernel, out) -> out\n\n"
+    "Convolves the 3 dimensional float32 or uint16 array src with the float32\n"
+    "kernel and writes the result to the float32 array out (same shape as src).\n"
+    "Voxels closer than half a kernel to the border of out are not written,\n"
+    "out must not share memory with src or kernel.\n"
+    "Arrays are used in place, the GIL is released during the computation.";
+
+  PyObject* convolve_3d(PyObject*, PyObject* _args, PyObject* _kwargs){
+
+    static const char* keywords[] = {"src", "kernel", "out", 0};
+    PyObject* src_object = 0;
+    PyObject* kernel_object = 0;
+    PyObject* out_object = 0;
+
+    if(!PyArg_ParseTupleAndKeywords(_args, _kwargs, "OOO:convolve_3d", const_cast<char**>(keywords),
+				    &src_object, &kernel_object, &out_object))
+      return 0;
+
+    buffers views;
+    if(!views.acquire(src_object, PyBUF_STRIDES | PyBUF_FORMAT) ||
+       !views.acquire(kernel_object, PyBUF_STRIDES | PyBUF_FORMAT) ||
+       !views.acquire(out_object, PyBUF_STRIDES | PyBUF_FORMAT | PyBUF_WRITABLE))
+      return 0;
+
+    size_t extents[3];
+    size_t kernel_extents[3];
+    size_t out_extents[3];
+    ptrdiff_t strides[3];
+    ptrdiff_t kernel_strides[3];
+    ptrdiff_t out_strides[3];
+
+    if(!describe(views[0], "src", extents, strides) ||
+       !describe(views[1], "kernel", kernel_extents, kernel_strides) ||
+       !describe(views[2], "out", out_extents, out_strides))
+      return 0;
+
+    const char src_type = buffer_type(views[0]);
+    if(!((src_type == 'f' && views[0].itemsize == 4) || (src_type == 'H' && views[0].itemsize == 2))){
+      PyErr_SetString(PyExc_TypeError, "src has to hold float32 or uint16 values");
+      return 0;
+    }
+
+    if(buffer_type(views[1]) != 'f' || views[1].itemsize != 4 ||
+       buffer_type(views[2]) != 'f' || views[2].itemsize != 4){
+      PyErr_SetString(PyExc_TypeError, "kernel and out have to hold float32 values");
+      return 0;
+    }
+
+    if(std::memcmp(extents, out_extents, sizeof(extents)) != 0){
+      PyErr_SetString(PyExc_ValueError, "src and out have to have the same shape");
+      return 0;
+    }
+
+    //out is written while src and kernel are still read
+    if(overlap(views[0], views[2]) || overlap(views[1], views[2])){
+      PyErr_SetString(PyExc_ValueError, "out must not overlap src or kernel");
+      return 0;
+    }
+
+    int status = ANYFOLD_SUCCESS;
+
+    Py_BEGIN_ALLOW_THREADS
+    if(src_type == 'f')
+      status = anyfold_convolve_3d(static_cast<const float*>(views[0].buf), extents, strides,
+				   static_cast<const float*>(views[1].buf), kernel_extents, kernel_strides,
+				   static_cast<float*>(views[2].buf), out_strides);
+    else
+      status = anyfold_convolve_3d_u16(static_cast<const unsigned short*>(views[0].buf), extents, strides,
+				       static_cast<const float*>(views[1].buf), kernel_extents, kernel_strides,
+				       static_cast<float*>(views[2].buf), out_strides);
+    Py_END_ALLOW_THREADS
+
+    if(status == ANYFOLD_ERROR_OUT_OF_MEMORY)
+      return PyErr_NoMemory();
+
+    if(status != ANYFOLD_SUCCESS){
+      PyErr_Format(PyExc_RuntimeError, "anyfold_convolve_3d failed: %s", anyfold_status_string(status));
+      return 0;
+    }
+
+    Py_INCREF(out_object);
+    return out_object;
+  }
+
+  PyObject* active_isa(PyObject*, PyObject*){
+    return PyUnicode_FromString(anyfold_active_isa());
+  }
+
+  PyMethodDef methods[] = {
+    {"convolve_3d", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(convolve_3d)),
+     METH_VARARGS | METH_KEYWORDS, convolve_3d_doc},
+    {"active_isa", active_isa, METH_NOARGS,
+     "active_isa() -> str\n\ninstruction set the anyfold kernels were dispatched to"},
+    {0, 0, 0, 0}
+  };
+
+  PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "anyfold",
+    "zero-copy python bindings of the anyfold convolution library",
+    -1,
+    methods,
+    0, 0, 0, 0
+  };
+
+};
+
+PyMODINIT_FUNC PyInit_anyfold(void){
+  return PyModule_Create(&module);
+}
@@ -0,0 +1,125 @@
+/**
+   implementation of the C API (anyfold.h) on top of the dispatched kernels
+*/
+#include <algorithm>
+#include <new>
+#include <exception>
+
+#include "anyfold.h"
+#include "cpu/compiled.hpp"
+
+namespace {
+
+  bool is_contiguous(const size_t* _extents, const ptrdiff_t* _strides){
+    if(!_strides)
+      return true;
+
+    ptrdiff_t expected = 1;
+    for(int d = 2;d>=0;--d){
+      if(_extents[d] > 1 && _strides[d] != expected)
+	return false;
+      expected *= ptrdiff_t(_extents[d]);
+    }
+
+    return true;
+  }
+
+  //element strides as long, contiguous row-major ones if none are given
+  void strides_of(const size_t* _extents, const ptrdiff_t* _strides, long* _result){
+    if(_strides){
+      std::copy(_strides, _strides + 3, _result);
+      return;
+    }
+
+    _result[2] = 1;
+    _result[1] = long(_extents[2]);
+    _result[0] = long(_extents[1]*_extents[2]);
+  }
+
+  template <typename SrcT>
+  int convolve(const SrcT* _src, const size_t* _extents, const ptrdiff_t* _strides,
+	       const float* _kernel, const size_t* _kernel_extents, const ptrdiff_t* _kernel_strides,
+	       float* _out, const ptrdiff_t* _out_strides){
+
+    if(!_src || !_extents || !_kernel || !_kernel_extents || !_out)
+      return ANYFOLD_ERROR_INVALID_ARGUMENT;
+
+    long image_shape[3];
+    long kernel_shape[3];
+    for(int d = 0;d<3;++d){
+      if(_kernel_extents[d] < 1)
+	return ANYFOLD_ERROR_INVALID_ARGUMENT;
+      image_shape[d] = _extents[d];
+      kernel_shape[d] = _kernel_extents[d];
+    }
+
+    if(!_extents[0] || !_extents[1] || !_extents[2])
+      return ANYFOLD_SUCCESS;
+
+    try {
+      //contiguous data takes the convolve_3d path (box filter for uniform kernels),
+      //everything else is addressed in place through its strides
+      if(is_contiguous(_extents, _strides) &&
+	 is_contiguous(_kernel_extents, _kernel_strides) &&
+	 is_contiguous(_extents, _out_strides)){
+	anyfold::cpu::compiled::convolve_3d(_src, image_shape, _kernel, kernel_shape, _out);
+      }
+      else {
+	long image_strides[3];
+	long kernel_strides[3];
+	long out_strides[3];
+	strides_of(_extents, _strides, image_strides);
+	strides_of(_kernel_extents, _kernel_strides, kernel_strides);
+	strides_of(_extents, _out_strides, out_strides);
+
+	anyfold::cpu::compiled::convolve_3d(_src, image_shape, image_strides,
+					    _kernel, kernel_shape, kernel_strides,
+					    _out, out_strides);
+      }
+    }
+    catch(std::bad_alloc&){
+      return ANYFOLD_ERROR_OUT_OF_MEMORY;
+    }
+    catch(...){
+      return ANYFOLD_ERROR_INTERNAL;
+    }
+
+    return ANYFOLD_SUCCESS;
+  }
+
+};
+
+extern "C" {
+
+  int anyfold_convolve_3d(const float* src, const size_t* extents, const ptrdiff_t* strides,
+			  const float* kernel, const size_t* kernel_extents, const ptrdiff_t* kernel_strides,
+			  float* out, const ptrdiff_t* out_strides){
+    return convolve(src, extents, strides, kernel, kernel_extents, kernel_strides, out, out_strides);
+  }
+
+  int anyfold_convolve_3d_u16(const unsigned short* src, const size_t* extents, const ptrdiff_t* strides,
+			      const float* kernel, const size_t* kernel_extents, const ptrdiff_t* kernel_strides,
+			      float* out, const ptrdiff_t* out_strides){
+    return convolve(src, extents, strides, kernel, kernel_extents, kernel_strides, out, out_strides);
+  }
+
+  const char* anyfold_status_string(int status){
+    switch(status){
+    case ANYFOLD_SUCCESS:
+      return "success";
+    case ANYFOLD_ERROR_INVALID_ARGUMENT:
+      return "invalid argument";
+    case ANYFOLD_ERROR_OUT_OF_MEMORY:
+      return "out of memory";
+    case ANYFOLD_ERROR_INTERNAL:
+      return "internal error";
+    default:
+      return "unknown status";
+    }
+  }
+
+  const char* anyfold_active_isa(void){
+    return anyfold::cpu::compiled::isa_name(anyfold::cpu::compiled::active_isa());
+  }
+
+}
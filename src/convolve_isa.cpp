@@ -0,0 +1,113 @@
+/**
+   kernels of the anyfold library for one instruction set level
+
+   this file is compiled once per level (see src/CMakeLists.txt) with the
+   matching -m flags and ANYFOLD_ISA_NAMESPACE set to anyfold_isa_<level>; the
+   header-only implementation is included into that namespace so every level
+   gets its own copy of the anyfold template instantiations; std:: and boost::
+   instantiations are weak symbols outside of that namespace, they are renamed
+   per level after compilation (see src/localize_isa_symbols.cmake)
+
+   all headers that the anyfold headers pull in have to be included before
+   opening the namespace
+*/
+#ifndef ANYFOLD_ISA_NAMESPACE
+#error "ANYFOLD_ISA_NAMESPACE has to be defined when compiling convolve_isa.cpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "boost/multi_array.hpp"
+
+#include "isa_kernels.hpp"
+
+ANYFOLD_DECLARE_ISA_KERNELS(ANYFOLD_ISA_NAMESPACE)
+
+namespace ANYFOLD_ISA_NAMESPACE {
+
+#include "cpu/convolve.hpp"
+#include "cpu/fused.hpp"
+#include "cpu/view.hpp"
+
+  //explicit instantiations of the kernels exported through the dispatcher
+  template void anyfold::cpu::convolve_3d<long, const float*, const float*, float*>(const float*, long*,
+										  const float*, long*,
+										  float*);
+
+  template void anyfold::cpu::box_filter_3d<long, const unsigned short*, float, float*>(const unsigned short*, long*,
+											 long*, const float&,
+											 float*);
+
+  template void anyfold::cpu::convolve_3d_fused<long, const unsigned short*, const float*, float*,
+						anyfold::cpu::epilogue::identity>(const unsigned short*, long*,
+										  const float*, long*,
+										  float*,
+										  const anyfold::cpu::epilogue::identity&);
+
+  void convolve_3d_f32(const float* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out){
+
+    long image_shape[3];
+    long kernel_shape[3];
+    std::copy(_src_extents, _src_extents + 3, image_shape);
+    std::copy(_kernel_extents, _kernel_extents + 3, kernel_shape);
+
+    anyfold::cpu::convolve_3d(_src, image_shape, _kernel, kernel_shape, _out);
+  }
+
+  void convolve_3d_u16(const unsigned short* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out){
+
+    long image_shape[3];
+    long kernel_shape[3];
+    std::copy(_src_extents, _src_extents + 3, image_shape);
+    std::copy(_kernel_extents, _kernel_extents + 3, kernel_shape);
+
+    //the multi_array based generic path of convolve_3d is float only
+    if(anyfold::cpu::is_uniform_kernel(_kernel, kernel_shape))
+      anyfold::cpu::box_filter_3d(_src, image_shape, kernel_shape, *_kernel, _out);
+    else
+      anyfold::cpu::convolve_3d_fused(_src, image_shape, _kernel, kernel_shape, _out,
+				      anyfold::cpu::epilogue::identity());
+  }
+
+  void convolve_3d_view_f32(const float* _src, const long* _src_extents, const long* _src_strides,
+			    const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+			    float* _out, const long* _out_strides){
+
+    long image_shape[3];
+    long kernel_shape[3];
+    std::copy(_src_extents, _src_extents + 3, image_shape);
+    std::copy(_kernel_extents, _kernel_extents + 3, kernel_shape);
+
+    anyfold::cpu::convolve_3d_view(_src, image_shape, _src_strides,
+				   _kernel, kernel_shape, _kernel_strides,
+				   _out, _out_strides);
+  }
+
+  void convolve_3d_view_u16(const unsigned short* _src, const long* _src_extents, const long* _src_strides,
+			    const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+			    float* _out, const long* _out_strides){
+
+    long image_shape[3];
+    long kernel_shape[3];
+    std::copy(_src_extents, _src_extents + 3, image_shape);
+    std::copy(_kernel_extents, _kernel_extents + 3, kernel_shape);
+
+    anyfold::cpu::convolve_3d_view(_src, image_shape, _src_strides,
+				   _kernel, kernel_shape, _kernel_strides,
+				   _out, _out_strides);
+  }
+
+}
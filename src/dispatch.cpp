@@ -0,0 +1,177 @@
+/**
+   selects the kernels of the best instruction set level that was compiled into
+   the library and that the host cpu supports, once when the library is loaded
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "cpu/compiled.hpp"
+#include "isa_kernels.hpp"
+
+ANYFOLD_DECLARE_ISA_KERNELS(anyfold_isa_generic)
+
+#ifdef ANYFOLD_WITH_SSE42
+ANYFOLD_DECLARE_ISA_KERNELS(anyfold_isa_sse42)
+#endif
+
+#ifdef ANYFOLD_WITH_AVX2
+ANYFOLD_DECLARE_ISA_KERNELS(anyfold_isa_avx2)
+#endif
+
+#ifdef ANYFOLD_WITH_AVX512
+ANYFOLD_DECLARE_ISA_KERNELS(anyfold_isa_avx512)
+#endif
+
+namespace anyfold {
+
+  namespace cpu {
+
+    namespace compiled {
+
+      namespace {
+
+	struct kernel_table {
+	  void (*convolve_3d_f32)(const float*, const long*, const float*, const long*, float*);
+	  void (*convolve_3d_u16)(const unsigned short*, const long*, const float*, const long*, float*);
+	  void (*convolve_3d_view_f32)(const float*, const long*, const long*,
+				       const float*, const long*, const long*, float*, const long*);
+	  void (*convolve_3d_view_u16)(const unsigned short*, const long*, const long*,
+				       const float*, const long*, const long*, float*, const long*);
+	};
+
+	//indexed by isa_level, levels that were not compiled have no kernels
+	const kernel_table tables[isa_count] = {
+	  { anyfold_isa_generic::convolve_3d_f32, anyfold_isa_generic::convolve_3d_u16,
+	    anyfold_isa_generic::convolve_3d_view_f32, anyfold_isa_generic::convolve_3d_view_u16 },
+#ifdef ANYFOLD_WITH_SSE42
+	  { anyfold_isa_sse42::convolve_3d_f32, anyfold_isa_sse42::convolve_3d_u16,
+	    anyfold_isa_sse42::convolve_3d_view_f32, anyfold_isa_sse42::convolve_3d_view_u16 },
+#else
+	  { 0, 0, 0, 0 },
+#endif
+#ifdef ANYFOLD_WITH_AVX2
+	  { anyfold_isa_avx2::convolve_3d_f32, anyfold_isa_avx2::convolve_3d_u16,
+	    anyfold_isa_avx2::convolve_3d_view_f32, anyfold_isa_avx2::convolve_3d_view_u16 },
+#else
+	  { 0, 0, 0, 0 },
+#endif
+#ifdef ANYFOLD_WITH_AVX512
+	  { anyfold_isa_avx512::convolve_3d_f32, anyfold_isa_avx512::convolve_3d_u16,
+	    anyfold_isa_avx512::convolve_3d_view_f32, anyfold_isa_avx512::convolve_3d_view_u16 }
+#else
+	  { 0, 0, 0, 0 }
+#endif
+	};
+
+	const char* names[isa_count] = { "generic", "sse42", "avx2", "avx512" };
+
+	bool cpu_supports(isa_level _level){
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	  __builtin_cpu_init();
+	  switch(_level){
+	  case isa_sse42:
+	    return __builtin_cpu_supports("sse4.2");
+	  case isa_avx2:
+	    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	  case isa_avx512:
+	    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") &&
+	      __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+	      __builtin_cpu_supports("avx512vl");
+	  default:
+	    break;
+	  }
+#endif
+	  return _level == isa_generic;
+	}
+
+	//best available level, capped by the ANYFOLD_ISA environment variable
+	isa_level detect_isa(){
+
+	  int cap = isa_count - 1;
+	  const char* requested = std::getenv("ANYFOLD_ISA");
+	  if(requested && *requested){
+	    cap = -1;
+	    for(int level = 0;level<isa_count;++level)
+	      if(std::strcmp(requested, names[level]) == 0)
+		cap = level;
+
+	    //a misspelled cap must not silently enable the widest level
+	    if(cap < 0){
+	      std::fprintf(stderr, "[anyfold]\tunknown ANYFOLD_ISA=%s (expected generic, sse42, avx2 or avx512), using generic\n",
+			   requested);
+	      cap = isa_generic;
+	    }
+	  }
+
+	  for(int level = cap;level>isa_generic;--level)
+	    if(isa_available(isa_level(level)))
+	      return isa_level(level);
+
+	  return isa_generic;
+	}
+
+	isa_level active = detect_isa();
+
+      };
+
+      const char* isa_name(isa_level _level){
+	return (_level >= 0 && _level < isa_count) ? names[_level] : "unknown";
+      }
+
+      bool isa_available(isa_level _level){
+	if(_level < 0 || _level >= isa_count || !tables[_level].convolve_3d_f32)
+	  return false;
+
+	return cpu_supports(_level);
+      }
+
+      isa_level active_isa(){
+	return active;
+      }
+
+      void select_isa(isa_level _level){
+	if(!isa_available(_level)){
+	  std::ostringstream msg;
+	  msg << "[anyfold::compiled::select_isa]\tinstruction set " << isa_name(_level)
+	      << " not available on this host or not compiled in\n";
+	  throw std::runtime_error(msg.str().c_str());
+	}
+
+	active = _level;
+      }
+
+      void convolve_3d(const float* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out){
+	tables[active].convolve_3d_f32(_src, _src_extents, _kernel, _kernel_extents, _out);
+      }
+
+      void convolve_3d(const unsigned short* _src, const long* _src_extents,
+		       const float* _kernel, const long* _kernel_extents,
+		       float* _out){
+	tables[active].convolve_3d_u16(_src, _src_extents, _kernel, _kernel_extents, _out);
+      }
+
+      void convolve_3d(const float* _src, const long* _src_extents, const long* _src_strides,
+		       const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+		       float* _out, const long* _out_strides){
+	tables[active].convolve_3d_view_f32(_src, _src_extents, _src_strides,
+					    _kernel, _kernel_extents, _kernel_strides,
+					    _out, _out_strides);
+      }
+
+      void convolve_3d(const unsigned short* _src, const long* _src_extents, const long* _src_strides,
+		       const float* _kernel, const long* _kernel_extents, const long* _kernel_strides,
+		       float* _out, const long* _out_strides){
+	tables[active].convolve_3d_view_u16(_src, _src_extents, _src_strides,
+					    _kernel, _kernel_extents, _kernel_strides,
+					    _out, _out_strides);
+      }
+
+    };
+  };
+};
@@ -0,0 +1,26 @@
+#ifndef _ISA_KERNELS_HPP_
+#define _ISA_KERNELS_HPP_
+
+/**
+   entry points that convolve_isa.cpp defines once per instruction set level,
+   each copy lives in its own namespace (anyfold_isa_<level>) so that the
+   anyfold template instantiations of different levels are distinct symbols
+   (std:: and boost:: ones are renamed by localize_isa_symbols.cmake)
+*/
+#define ANYFOLD_DECLARE_ISA_KERNELS(NS)					\
+  namespace NS {							\
+    void convolve_3d_f32(const float* _src, const long* _src_extents,	\
+			 const float* _kernel, const long* _kernel_extents, \
+			 float* _out);					\
+    void convolve_3d_u16(const unsigned short* _src, const long* _src_extents, \
+			 const float* _kernel, const long* _kernel_extents, \
+			 float* _out);					\
+    void convolve_3d_view_f32(const float* _src, const long* _src_extents, const long* _src_strides, \
+			      const float* _kernel, const long* _kernel_extents, const long* _kernel_strides, \
+			      float* _out, const long* _out_strides);	\
+    void convolve_3d_view_u16(const unsigned short* _src, const long* _src_extents, const long* _src_strides, \
+			      const float* _kernel, const long* _kernel_extents, const long* _kernel_strides, \
+			      float* _out, const long* _out_strides);	\
+  }
+
+#endif /* _ISA_KERNELS_HPP_ */
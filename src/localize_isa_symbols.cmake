@@ -0,0 +1,45 @@
+# gives the vague linkage symbols of one instruction set level object a level
+# specific name, run as
+#   cmake -DNM=.. -DOBJCOPY=.. -DINPUT=<object> -DOUTPUT=<object> -DSUFFIX=<level> -P localize_isa_symbols.cmake
+#
+# inline functions and template instantiations outside of the ISA namespace
+# (std::, boost::) are emitted as weak/COMDAT symbols in every level; the linker
+# keeps only one of them (the first object on the link line wins), so avx512
+# code could end up being called from the generic kernels. Renaming them per
+# level makes every level object self-contained.
+
+execute_process(COMMAND ${NM} -P --defined-only ${INPUT}
+  OUTPUT_VARIABLE symbols
+  RESULT_VARIABLE nm_result)
+
+IF(NOT nm_result EQUAL 0)
+  MESSAGE(FATAL_ERROR "unable to list the symbols of ${INPUT}")
+ENDIF()
+
+STRING(REPLACE "\n" ";" symbols "${symbols}")
+SET(renames "")
+FOREACH(line ${symbols})
+  # name type [value size]: weak (W,V) and unique global (u) definitions, and
+  # the local keys (n) of the COMDAT groups holding constructor/destructor
+  # aliases (C5/D5), groups are merged by these keys even though they are local
+  SET(name "")
+  IF(line MATCHES "^([^ ]+) [WVu]( |$)")
+    SET(name ${CMAKE_MATCH_1})
+  ELSEIF(line MATCHES "^(_Z[^ ]+) n( |$)")
+    SET(name ${CMAKE_MATCH_1})
+  ENDIF()
+  # the personality routine reference is shared by design and harmless
+  IF(name AND NOT name MATCHES "^DW\\.ref\\.")
+    SET(renames "${renames}${name} ${name}.${SUFFIX}\n")
+  ENDIF()
+ENDFOREACH()
+
+SET(renames_file "${OUTPUT}.renames")
+file(WRITE ${renames_file} "${renames}")
+
+execute_process(COMMAND ${OBJCOPY} --redefine-syms=${renames_file} ${INPUT} ${OUTPUT}
+  RESULT_VARIABLE objcopy_result)
+
+IF(NOT objcopy_result EQUAL 0)
+  MESSAGE(FATAL_ERROR "unable to rename the symbols of ${INPUT}")
+ENDIF()
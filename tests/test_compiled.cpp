@@ -0,0 +1,87 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE COMPILED_KERNELS
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "anyfold.hpp"
+#include "cpu/compiled.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+namespace ac = anyfold::cpu::compiled;
+
+typedef anyfold::convolutionFixture3D<5,12> compiled_fixture;
+
+BOOST_FIXTURE_TEST_SUITE( compiled_kernels_work, compiled_fixture )
+
+BOOST_AUTO_TEST_CASE( generic_always_available )
+{
+  BOOST_CHECK(ac::isa_available(ac::isa_generic));
+  BOOST_CHECK(ac::isa_available(ac::active_isa()));
+  BOOST_CHECK_EQUAL(std::string(ac::isa_name(ac::isa_avx2)), "avx2");
+  BOOST_CHECK_THROW(ac::select_isa(ac::isa_count), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( all_levels_match_header_only_float )
+{
+  const ac::isa_level loaded = ac::active_isa();
+  std::vector<long> image_shape(padded_image_shape_.begin(), padded_image_shape_.end());
+  std::vector<long> kernel_shape(kernel_dims_.begin(), kernel_dims_.end());
+
+  anyfold::image_stack* kernels[] = { &horizontal_kernel_, &all1_kernel_ };
+  anyfold::image_stack* expected[] = { &padded_image_folded_by_horizontal_, &padded_image_folded_by_all1_ };
+
+  for(int level = 0;level<ac::isa_count;++level){
+    if(!ac::isa_available(ac::isa_level(level)))
+      continue;
+    ac::select_isa(ac::isa_level(level));
+
+    for(int k = 0;k<2;++k){
+      std::fill(padded_output_.data(), padded_output_.data() + padded_output_.num_elements(), 0.f);
+      ac::convolve_3d(padded_image_.data(), &image_shape[0],
+		      kernels[k]->data(), &kernel_shape[0],
+		      padded_output_.data());
+
+      float l2norm = anyfold::l2norm(padded_output_.data(), expected[k]->data(), padded_output_.num_elements());
+      BOOST_CHECK_MESSAGE(l2norm < 1e-3, ac::isa_name(ac::isa_level(level)) << " kernel " << k << " l2norm " << l2norm);
+    }
+  }
+
+  ac::select_isa(loaded);
+}
+
+BOOST_AUTO_TEST_CASE( all_levels_match_header_only_uint16 )
+{
+  const ac::isa_level loaded = ac::active_isa();
+  std::vector<long> image_shape(padded_image_shape_.begin(), padded_image_shape_.end());
+  std::vector<long> kernel_shape(kernel_dims_.begin(), kernel_dims_.end());
+
+  //fixture image holds integral values below 2^16
+  std::vector<unsigned short> image(padded_image_.data(), padded_image_.data() + padded_image_.num_elements());
+
+  anyfold::image_stack* kernels[] = { &depth_kernel_, &all1_kernel_ };
+  anyfold::image_stack* expected[] = { &padded_image_folded_by_depth_, &padded_image_folded_by_all1_ };
+
+  for(int level = 0;level<ac::isa_count;++level){
+    if(!ac::isa_available(ac::isa_level(level)))
+      continue;
+    ac::select_isa(ac::isa_level(level));
+
+    for(int k = 0;k<2;++k){
+      std::fill(padded_output_.data(), padded_output_.data() + padded_output_.num_elements(), 0.f);
+      ac::convolve_3d(&image[0], &image_shape[0],
+		      kernels[k]->data(), &kernel_shape[0],
+		      padded_output_.data());
+
+      float l2norm = anyfold::l2norm(padded_output_.data(), expected[k]->data(), padded_output_.num_elements());
+      BOOST_CHECK_MESSAGE(l2norm < 1e-3, ac::isa_name(ac::isa_level(level)) << " kernel " << k << " l2norm " << l2norm);
+    }
+  }
+
+  ac::select_isa(loaded);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
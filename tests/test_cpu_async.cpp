@@ -0,0 +1,137 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CPU_ASYNC
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "anyfold.hpp"
+#include "cpu/async.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+BOOST_FIXTURE_TEST_SUITE( async_convolution_works, anyfold::default_3D_fixture )
+
+BOOST_AUTO_TEST_CASE( async_matches_convolve_3d )
+{
+
+  std::future<void> done = anyfold::cpu::convolve_3d_async(padded_image_.data(),(int*)&padded_image_shape_[0],
+							    depth_kernel_.data(),&kernel_dims_[0],
+							    padded_output_.data());
+  done.get();
+
+  float l2norm = anyfold::l2norm(padded_output_.data(), padded_image_folded_by_depth_.data(),  padded_output_.num_elements());
+  BOOST_REQUIRE_CLOSE(l2norm, 0, .00001);
+}
+
+BOOST_AUTO_TEST_CASE( pipeline_processes_frames_in_order )
+{
+  const std::size_t num_frames = 7;
+  const std::size_t frame_size = padded_image_.num_elements();
+
+  anyfold::cpu::pipeline<float> frames(&padded_image_shape_[0],
+				       horizontal_kernel_.data(), &kernel_dims_[0],
+				       2);
+
+  //Boost.Test assertions are not thread safe, the stages only record
+  std::vector<std::size_t> saved;
+  std::vector<float> saved_l2norms;
+  std::atomic<int> loaded_ahead(0);
+  int max_loaded_ahead = 0;
+
+  //frame t is the fixture image scaled by t+1
+  frames.run([&](std::size_t t, float* frame){
+      for(std::size_t p = 0;p<frame_size;++p)
+	frame[p] = (t+1)*padded_image_.data()[p];
+      max_loaded_ahead = std::max(max_loaded_ahead, ++loaded_ahead);
+    },
+    [&](std::size_t t, const float* frame){
+      //slow consumer, the loader has to wait for free buffers
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      --loaded_ahead;
+
+      float l2norm = 0;
+      for(std::size_t p = 0;p<frame_size;++p){
+	const float diff = frame[p] - (t+1)*padded_image_folded_by_horizontal_.data()[p];
+	l2norm += diff*diff;
+      }
+      saved_l2norms.push_back(l2norm);
+      saved.push_back(t);
+    },
+    num_frames);
+
+  BOOST_REQUIRE_EQUAL(saved.size(), num_frames);
+  for(std::size_t t = 0;t<num_frames;++t){
+    BOOST_CHECK_EQUAL(saved[t], t);
+    BOOST_CHECK_SMALL(saved_l2norms[t], 1e-4f);
+  }
+
+  //queue_depth+1 input and queue_depth+1 output buffers bound the frames in flight
+  BOOST_CHECK_LE(max_loaded_ahead, int(2*(frames.queue_depth() + 1)));
+}
+
+BOOST_AUTO_TEST_CASE( pipeline_convolves_uint16_frames )
+{
+  const std::size_t num_frames = 3;
+  const std::size_t frame_size = padded_image_.num_elements();
+
+  //non-integer weights must not be truncated
+  std::vector<float> kernel(horizontal_kernel_.data(), horizontal_kernel_.data() + horizontal_kernel_.num_elements());
+  for(std::size_t p = 0;p<kernel.size();++p)
+    kernel[p] *= .25f;
+
+  std::vector<float> image(frame_size);
+  for(std::size_t p = 0;p<frame_size;++p)
+    image[p] = float((p*7) % 101);
+
+  std::vector<float> expected(frame_size, 0.f);
+  anyfold::cpu::convolve_3d(&image[0], &padded_image_shape_[0],
+			    &kernel[0], &kernel_dims_[0],
+			    &expected[0]);
+
+  anyfold::cpu::pipeline<unsigned short> frames(&padded_image_shape_[0],
+						&kernel[0], &kernel_dims_[0]);
+
+  std::vector<float> saved_l2norms;
+  frames.run([&](std::size_t, unsigned short* frame){
+      for(std::size_t p = 0;p<frame_size;++p)
+	frame[p] = (unsigned short)(image[p]);
+    },
+    [&](std::size_t, const float* frame){
+      float l2norm = 0;
+      for(std::size_t p = 0;p<frame_size;++p)
+	l2norm += (frame[p] - expected[p])*(frame[p] - expected[p]);
+      saved_l2norms.push_back(l2norm);
+    },
+    num_frames);
+
+  BOOST_REQUIRE_EQUAL(saved_l2norms.size(), num_frames);
+  for(std::size_t t = 0;t<num_frames;++t)
+    BOOST_CHECK_SMALL(saved_l2norms[t], 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE( pipeline_rethrows_stage_errors )
+{
+  anyfold::cpu::pipeline<float> frames(&padded_image_shape_[0],
+				       identity_kernel_.data(), &kernel_dims_[0]);
+
+  std::size_t saved = 0;
+  BOOST_CHECK_THROW(frames.run([&](std::size_t t, float* frame){
+	if(t == 3)
+	  throw std::runtime_error("unable to read frame");
+	std::fill(frame, frame + padded_image_.num_elements(), 1.f);
+      },
+      [&](std::size_t, const float*){
+	++saved;
+      },
+      10),
+    std::runtime_error);
+
+  BOOST_CHECK_LE(saved, 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
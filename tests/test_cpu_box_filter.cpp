@@ -0,0 +1,89 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CPU_BOX_FILTER
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include "anyfold.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+BOOST_FIXTURE_TEST_SUITE( box_filter_works, anyfold::default_3D_fixture )
+
+BOOST_AUTO_TEST_CASE( uniform_kernels_detected )
+{
+  BOOST_CHECK(anyfold::cpu::is_uniform_kernel(all1_kernel_.data(), &kernel_dims_[0]));
+  BOOST_CHECK(anyfold::cpu::is_uniform_kernel(trivial_kernel_.data(), &kernel_dims_[0]));
+  BOOST_CHECK(!anyfold::cpu::is_uniform_kernel(identity_kernel_.data(), &kernel_dims_[0]));
+  BOOST_CHECK(!anyfold::cpu::is_uniform_kernel(horizontal_kernel_.data(), &kernel_dims_[0]));
+}
+
+BOOST_AUTO_TEST_CASE( all1_box_filter )
+{
+
+  anyfold::cpu::box_filter_3d(padded_image_.data(),(int*)&padded_image_shape_[0],
+			      &kernel_dims_[0], 1.f,
+			      padded_output_.data());
+
+  float l2norm = anyfold::l2norm(padded_output_.data(), padded_image_folded_by_all1_.data(),  padded_output_.num_elements());
+  BOOST_REQUIRE_CLOSE(l2norm, 0, .00001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( box_filter_matches_reference )
+
+BOOST_AUTO_TEST_CASE( anisotropic_kernels )
+{
+  const int kernel_shapes[][3] = { {1,1,1}, {5,5,5}, {3,5,7}, {7,1,3}, {9,9,9}, {4,3,3}, {2,6,4} };
+  std::vector<int> image_shape(3);
+  image_shape[0] = 19; image_shape[1] = 16; image_shape[2] = 23;
+
+  anyfold::image_stack image(boost::extents[image_shape[0]][image_shape[1]][image_shape[2]]);
+  for (unsigned pixel = 0; pixel < image.num_elements(); ++pixel)
+    image.data()[pixel] = float((pixel*7) % 31)/4.f;
+
+  for(unsigned k = 0;k<sizeof(kernel_shapes)/sizeof(kernel_shapes[0]);++k){
+    std::vector<int> kernel_shape(kernel_shapes[k], kernel_shapes[k] + 3);
+
+    anyfold::image_stack kernel(boost::extents[kernel_shape[0]][kernel_shape[1]][kernel_shape[2]]);
+    std::fill(kernel.data(), kernel.data() + kernel.num_elements(), .5f);
+
+    anyfold::image_stack expected(image);
+    anyfold::image_stack result(image);
+
+    std::vector<int> offsets(kernel_shape);
+    for(unsigned i = 0;i<offsets.size();++i)
+      offsets[i] /= 2;
+    anyfold::convolve(image, kernel, expected, offsets);
+
+    anyfold::cpu::convolve_3d(image.data(), &image_shape[0],
+			      kernel.data(), &kernel_shape[0],
+			      result.data());
+
+    float max_expected = anyfold::max_value(expected.data(), expected.num_elements());
+    float l1norm = anyfold::l1norm(result.data(), expected.data(), result.num_elements());
+    BOOST_CHECK_MESSAGE(l1norm < 1e-5*max_expected*result.num_elements(),
+			"kernel " << kernel_shape[0] << "x" << kernel_shape[1] << "x" << kernel_shape[2]
+			<< " l1norm " << l1norm);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( kernel_larger_than_image )
+{
+  std::vector<int> image_shape(3,4);
+  std::vector<int> kernel_shape(3,7);
+
+  std::vector<float> image(64,1.f);
+  std::vector<float> kernel(343,1.f);
+  std::vector<float> result(64,-1.f);
+
+  anyfold::cpu::convolve_3d(&image[0], &image_shape[0],
+			    &kernel[0], &kernel_shape[0],
+			    &result[0]);
+
+  BOOST_CHECK_EQUAL(std::count(result.begin(), result.end(), -1.f), 64);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CPU_FUSED
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include <limits>
+#include "anyfold.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+namespace ae = anyfold::cpu::epilogue;
+
+BOOST_FIXTURE_TEST_SUITE( fused_convolution_works, anyfold::default_3D_fixture )
+
+BOOST_AUTO_TEST_CASE( identity_epilogue )
+{
+
+  anyfold::cpu::convolve_3d_fused(padded_image_.data(),(int*)&padded_image_shape_[0],
+				  horizontal_kernel_.data(),&kernel_dims_[0],
+				  padded_output_.data(),
+				  ae::identity());
+
+  float l2norm = anyfold::l2norm(padded_output_.data(), padded_image_folded_by_horizontal_.data(),  padded_output_.num_elements());
+  BOOST_REQUIRE_CLOSE(l2norm, 0, .00001);
+}
+
+BOOST_AUTO_TEST_CASE( difference_of_kernels )
+{
+
+  anyfold::cpu::convolve_3d_fused(padded_image_.data(),(int*)&padded_image_shape_[0],
+				  all1_kernel_.data(),&kernel_dims_[0],
+				  depth_kernel_.data(),&kernel_dims_[0],
+				  padded_output_.data(),
+				  ae::difference());
+
+  anyfold::image_stack expected(padded_image_folded_by_all1_);
+  for(unsigned p = 0;p<expected.num_elements();++p)
+    expected.data()[p] -= padded_image_folded_by_depth_.data()[p];
+
+  float l2norm = anyfold::l2norm(padded_output_.data(), expected.data(),  padded_output_.num_elements());
+  BOOST_REQUIRE_CLOSE(l2norm, 0, .00001);
+}
+
+BOOST_AUTO_TEST_CASE( affine_threshold_chain )
+{
+
+  const float level = 3000.f;
+  anyfold::cpu::convolve_3d_fused(padded_image_.data(),(int*)&padded_image_shape_[0],
+				  all1_kernel_.data(),&kernel_dims_[0],
+				  padded_output_.data(),
+				  ae::compose(ae::affine(.5, 10.), ae::threshold(level, -1.)));
+
+  std::vector<unsigned> offsets(3,kernel_axis_size/2);
+  for(int x = offsets[0];x<int(padded_output_.shape()[0]-offsets[0]);++x)
+    for(int y = offsets[1];y<int(padded_output_.shape()[1]-offsets[1]);++y)
+      for(int z = offsets[2];z<int(padded_output_.shape()[2]-offsets[2]);++z){
+	float expected = .5f*padded_image_folded_by_all1_[x][y][z] + 10.f;
+	if(expected < level)
+	  expected = -1.f;
+	BOOST_REQUIRE_CLOSE(padded_output_[x][y][z], expected, .00001);
+      }
+}
+
+BOOST_AUTO_TEST_CASE( saturating_output )
+{
+
+  std::vector<unsigned short> output(padded_output_.num_elements(), 42);
+
+  anyfold::cpu::convolve_3d_fused(padded_image_.data(),(int*)&padded_image_shape_[0],
+				  all1_kernel_.data(),&kernel_dims_[0],
+				  identity_kernel_.data(),&kernel_dims_[0],
+				  &output[0],
+				  ae::compose(ae::difference(), ae::compose(ae::affine(10.), ae::saturate_cast<unsigned short>())));
+
+  std::vector<unsigned> offsets(3,kernel_axis_size/2);
+  const unsigned n1 = padded_output_.shape()[1];
+  const unsigned n2 = padded_output_.shape()[2];
+  for(int x = offsets[0];x<int(padded_output_.shape()[0]-offsets[0]);++x)
+    for(int y = offsets[1];y<int(n1-offsets[1]);++y)
+      for(int z = offsets[2];z<int(n2-offsets[2]);++z){
+	double expected = 10.*(padded_image_folded_by_all1_[x][y][z] - padded_image_[x][y][z]);
+	expected = std::min(expected, double(std::numeric_limits<unsigned short>::max()));
+	BOOST_REQUIRE_EQUAL(output[(x*n1 + y)*n2 + z], (unsigned short)(expected));
+      }
+
+  BOOST_CHECK_EQUAL(output[0], 42);
+}
+
+BOOST_AUTO_TEST_CASE( saturate_cast_clamps )
+{
+  ae::saturate_cast<unsigned short> to_u16;
+  BOOST_CHECK_EQUAL(to_u16(-5.), 0);
+  BOOST_CHECK_EQUAL(to_u16(1e9), std::numeric_limits<unsigned short>::max());
+  BOOST_CHECK_EQUAL(to_u16(41.6), 42);
+
+  ae::saturate_cast<float> to_float;
+  BOOST_CHECK_CLOSE(to_float(-5.5), -5.5f, .00001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
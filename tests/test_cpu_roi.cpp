@@ -0,0 +1,144 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CPU_ROI
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "anyfold.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+typedef anyfold::convolutionFixture3D<3,16> roi_fixture;
+
+BOOST_FIXTURE_TEST_SUITE( roi_convolution_works, roi_fixture )
+
+BOOST_AUTO_TEST_CASE( box_matches_full_convolution )
+{
+  //box touches the lower border of the image, where voxels are not valid
+  const int roi_begin[3] = {0,4,7};
+  const int roi_end[3] = {6,13,9};
+  const int roi_extents[3] = {6,9,2};
+
+  std::vector<float> output(roi_extents[0]*roi_extents[1]*roi_extents[2], -1.f);
+
+  anyfold::cpu::convolve_3d_roi(padded_image_.data(),(int*)&padded_image_shape_[0],
+				horizontal_kernel_.data(),&kernel_dims_[0],
+				output.begin(),
+				roi_begin, roi_end);
+
+  const int half_kernel = kernel_axis_size/2;
+  for(int x = 0;x<roi_extents[0];++x)
+    for(int y = 0;y<roi_extents[1];++y)
+      for(int z = 0;z<roi_extents[2];++z){
+	const float value = output[(x*roi_extents[1] + y)*roi_extents[2] + z];
+	if(x + roi_begin[0] < half_kernel)
+	  BOOST_REQUIRE_EQUAL(value, -1.f);
+	else
+	  BOOST_REQUIRE_CLOSE(value, padded_image_folded_by_horizontal_[x + roi_begin[0]][y + roi_begin[1]][z + roi_begin[2]], .00001);
+      }
+}
+
+BOOST_AUTO_TEST_CASE( box_outside_image_throws )
+{
+  const int roi_begin[3] = {0,0,0};
+  const int roi_end[3] = {6,6,100};
+  std::vector<float> output(6*6*100);
+
+  BOOST_CHECK_THROW(anyfold::cpu::convolve_3d_roi(padded_image_.data(),(int*)&padded_image_shape_[0],
+						  horizontal_kernel_.data(),&kernel_dims_[0],
+						  output.begin(),
+						  roi_begin, roi_end),
+		    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( masked_matches_full_convolution )
+{
+  std::vector<unsigned char> mask(padded_image_.num_elements(), 0);
+  for(unsigned p = 0;p<mask.size();p += 3)
+    mask[p] = 1;
+
+  std::fill(padded_output_.data(), padded_output_.data() + padded_output_.num_elements(), -1.f);
+  anyfold::cpu::convolve_3d_masked(padded_image_.data(),(int*)&padded_image_shape_[0],
+				   depth_kernel_.data(),&kernel_dims_[0],
+				   mask.begin(),
+				   padded_output_.data());
+
+  const int half_kernel = kernel_axis_size/2;
+  const int n = padded_image_shape_[0];
+  for(int x = 0;x<n;++x)
+    for(int y = 0;y<n;++y)
+      for(int z = 0;z<n;++z){
+	const bool is_valid = std::min(x,std::min(y,z)) >= half_kernel && std::max(x,std::max(y,z)) < n - half_kernel;
+	if(is_valid && mask[(x*n + y)*n + z])
+	  BOOST_REQUIRE_CLOSE(padded_output_[x][y][z], padded_image_folded_by_depth_[x][y][z], .00001);
+	else
+	  BOOST_REQUIRE_EQUAL(padded_output_[x][y][z], -1.f);
+      }
+}
+
+BOOST_AUTO_TEST_CASE( tiles_are_computed_lazily_and_evicted )
+{
+  //18^3 image in tiles of 8x8x5, i.e. 3x3x4 tiles with partial tiles at the upper end
+  const int tile_extents[3] = {8,8,5};
+
+  anyfold::cpu::tiled_convolution<const float*, const float*> lazy(padded_image_.data(), &padded_image_shape_[0],
+								   vertical_kernel_.data(), &kernel_dims_[0],
+								   tile_extents, 2);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), 0u);
+
+  const int half_kernel = kernel_axis_size/2;
+  const int n = padded_image_shape_[0];
+  for(int x = 0;x<n;++x)
+    for(int y = 0;y<n;++y)
+      for(int z = 0;z<n;++z){
+	const bool is_valid = std::min(x,std::min(y,z)) >= half_kernel && std::max(x,std::max(y,z)) < n - half_kernel;
+	const float expected = is_valid ? padded_image_folded_by_vertical_[x][y][z] : 0.f;
+	BOOST_REQUIRE_CLOSE(lazy(x,y,z), expected, .00001);
+      }
+
+  BOOST_CHECK_EQUAL(lazy.cached_tiles(), 2u);
+
+  //repeated access to a cached tile does not recompute it
+  const std::size_t computed = lazy.computed_tiles();
+  lazy(n-1,n-1,n-1);
+  lazy(n-2,n-2,n-2);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed);
+
+  //the least recently used tile is evicted first
+  lazy(0,0,0);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed + 1);
+  lazy(n-1,n-1,n-1);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed + 1);
+  lazy(0,0,6);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed + 2);
+  lazy(n-1,n-1,n-1);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed + 2);
+  lazy(0,0,0);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), computed + 3);
+  BOOST_CHECK_EQUAL(lazy.cached_tiles(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE( tiled_coordinates_outside_of_image_throw )
+{
+  const int tile_extents[3] = {8,8,5};
+
+  anyfold::cpu::tiled_convolution<const float*, const float*> lazy(padded_image_.data(), &padded_image_shape_[0],
+								   vertical_kernel_.data(), &kernel_dims_[0],
+								   tile_extents, 2);
+  const int n = padded_image_shape_[0];
+
+  BOOST_CHECK_THROW(lazy(-1,0,0), std::runtime_error);
+  BOOST_CHECK_THROW(lazy(0,n,0), std::runtime_error);
+  BOOST_CHECK_THROW(lazy(0,0,n), std::runtime_error);
+  BOOST_CHECK_THROW(lazy.tile(3,0,0), std::runtime_error);
+  BOOST_CHECK_THROW(lazy.tile(0,0,-1), std::runtime_error);
+  BOOST_CHECK_EQUAL(lazy.computed_tiles(), 0u);
+
+  //the last voxel lives in the partial tile at the upper end
+  BOOST_CHECK_NO_THROW(lazy(n-1,n-1,n-1));
+  BOOST_CHECK_NO_THROW(lazy.tile(2,2,3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
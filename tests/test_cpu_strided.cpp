@@ -0,0 +1,177 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CPU_STRIDED
+#include "boost/test/unit_test.hpp"
+#include "test_fixtures.hpp"
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "anyfold.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+typedef anyfold::convolutionFixture3D<3,16> strided_fixture;
+
+BOOST_FIXTURE_TEST_SUITE( strided_convolution_works, strided_fixture )
+
+BOOST_AUTO_TEST_CASE( unit_strides_match_convolve_3d )
+{
+  const int strides[3] = {1,1,1};
+
+  anyfold::cpu::convolve_3d(padded_image_.data(),(int*)&padded_image_shape_[0],
+			    horizontal_kernel_.data(),&kernel_dims_[0],
+			    padded_output_.data(), strides);
+
+  float l2norm = anyfold::l2norm(padded_output_.data(), padded_image_folded_by_horizontal_.data(),  padded_output_.num_elements());
+  BOOST_REQUIRE_CLOSE(l2norm, 0, .00001);
+}
+
+BOOST_AUTO_TEST_CASE( decimated_output_samples_full_output )
+{
+  const int strides[3] = {2,3,1};
+  int out_extents[3];
+  anyfold::cpu::decimated_extents(&padded_image_shape_[0], strides, out_extents);
+
+  BOOST_CHECK_EQUAL(out_extents[0], (int(padded_image_shape_[0]) + 1)/2);
+  BOOST_CHECK_EQUAL(out_extents[1], (int(padded_image_shape_[1]) + 2)/3);
+  BOOST_CHECK_EQUAL(out_extents[2], int(padded_image_shape_[2]));
+
+  std::vector<float> output(out_extents[0]*out_extents[1]*out_extents[2], -1.f);
+
+  anyfold::cpu::convolve_3d(padded_image_.data(),(int*)&padded_image_shape_[0],
+			    vertical_kernel_.data(),&kernel_dims_[0],
+			    &output[0], strides);
+
+  const int half_kernel = kernel_axis_size/2;
+  for(int x = 0;x<out_extents[0];++x)
+    for(int y = 0;y<out_extents[1];++y)
+      for(int z = 0;z<out_extents[2];++z){
+	const int src_x = x*strides[0];
+	const int src_y = y*strides[1];
+	const int src_z = z*strides[2];
+	const bool is_valid = src_x >= half_kernel && src_x < padded_image_shape_[0] - half_kernel &&
+	  src_y >= half_kernel && src_y < padded_image_shape_[1] - half_kernel &&
+	  src_z >= half_kernel && src_z < padded_image_shape_[2] - half_kernel;
+
+	const float value = output[(x*out_extents[1] + y)*out_extents[2] + z];
+	if(is_valid)
+	  BOOST_REQUIRE_CLOSE(value, padded_image_folded_by_vertical_[src_x][src_y][src_z], .00001);
+	else
+	  BOOST_REQUIRE_EQUAL(value, -1.f);
+      }
+}
+
+BOOST_AUTO_TEST_CASE( invalid_strides_throw )
+{
+  const int strides[3] = {2,0,1};
+
+  BOOST_CHECK_THROW(anyfold::cpu::convolve_3d(padded_image_.data(),(int*)&padded_image_shape_[0],
+					      vertical_kernel_.data(),&kernel_dims_[0],
+					      padded_output_.data(), strides),
+		    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( pyramid_levels_match_cascaded_decimation )
+{
+  const int factors[3] = {2,2,2};
+  const unsigned num_levels = 3;
+
+  std::vector<anyfold::cpu::pyramid_level<float> > levels;
+  anyfold::cpu::build_pyramid(padded_image_.data(),(int*)&padded_image_shape_[0],
+			      depth_kernel_.data(),&kernel_dims_[0],
+			      factors, num_levels, levels);
+
+  BOOST_REQUIRE_EQUAL(levels.size(), num_levels);
+
+  std::vector<float> source(padded_image_.data(), padded_image_.data() + padded_image_.num_elements());
+  std::vector<long> source_extents(padded_image_shape_.begin(), padded_image_shape_.end());
+
+  for(unsigned l = 0;l<num_levels;++l){
+
+    std::vector<long> expected_extents(3);
+    const long strides[3] = {2,2,2};
+    anyfold::cpu::decimated_extents(&source_extents[0], strides, &expected_extents[0]);
+
+    BOOST_REQUIRE(std::equal(expected_extents.begin(), expected_extents.end(), levels[l].extents()));
+
+    //border voxels are plain samples of the source level
+    std::vector<float> expected(levels[l].data_.size());
+    for(long x = 0;x<expected_extents[0];++x)
+      for(long y = 0;y<expected_extents[1];++y)
+	for(long z = 0;z<expected_extents[2];++z)
+	  expected[(x*expected_extents[1] + y)*expected_extents[2] + z] =
+	    source[(2*x*source_extents[1] + 2*y)*source_extents[2] + 2*z];
+
+    std::vector<long> kernel_extents(kernel_dims_.begin(), kernel_dims_.end());
+    anyfold::cpu::convolve_3d(&source[0], &source_extents[0],
+			      depth_kernel_.data(), &kernel_extents[0],
+			      &expected[0], strides);
+
+    float l2norm = anyfold::l2norm(levels[l].data(), &expected[0], expected.size());
+    BOOST_CHECK_MESSAGE(l2norm < 1e-6, "level " << l << " l2norm " << l2norm);
+
+    source = levels[l].data_;
+    source_extents = levels[l].extents_;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( uint16_pyramid_rounds_and_clamps )
+{
+  const int factors[3] = {2,2,2};
+  const unsigned num_levels = 2;
+  std::vector<int> source_extents(3,18);
+  std::vector<int> kernel_extents(3,3);
+
+  std::vector<unsigned short> source(18*18*18);
+  for(unsigned p = 0;p<source.size();++p)
+    source[p] = (p*37) % 1001;
+
+  //mean filter with fractional results, the second kernel is negative everywhere
+  std::vector<float> mean(27, 1.f/27.f);
+  std::vector<float> negative(27, -1.f/27.f);
+  std::vector<float>* kernels[] = { &mean, &negative };
+
+  for(int k = 0;k<2;++k){
+    std::vector<anyfold::cpu::pyramid_level<unsigned short> > levels;
+    anyfold::cpu::build_pyramid(&source[0], &source_extents[0],
+				&(*kernels[k])[0], &kernel_extents[0],
+				factors, num_levels, levels);
+    BOOST_REQUIRE_EQUAL(levels.size(), num_levels);
+
+    std::vector<unsigned short> previous(source);
+    std::vector<long> previous_extents(source_extents.begin(), source_extents.end());
+
+    for(unsigned l = 0;l<num_levels;++l){
+      const long* extents = levels[l].extents();
+      long mismatches = 0;
+
+      for(long x = 0;x<extents[0];++x)
+	for(long y = 0;y<extents[1];++y)
+	  for(long z = 0;z<extents[2];++z){
+	    const long sx = 2*x, sy = 2*y, sz = 2*z;
+	    const bool valid = sx >= 1 && sx < previous_extents[0] - 1 &&
+	      sy >= 1 && sy < previous_extents[1] - 1 &&
+	      sz >= 1 && sz < previous_extents[2] - 1;
+
+	    double value = previous[(sx*previous_extents[1] + sy)*previous_extents[2] + sz];
+	    if(valid){
+	      value = 0;
+	      for(long i = -1;i<=1;++i)
+		for(long j = -1;j<=1;++j)
+		  for(long m = -1;m<=1;++m)
+		    value += double((*kernels[k])[0])*previous[((sx+i)*previous_extents[1] + sy+j)*previous_extents[2] + sz+m];
+	    }
+
+	    const unsigned short expected = value <= 0 ? 0 : (unsigned short)(std::floor(value + .5));
+	    mismatches += levels[l].data_[(x*extents[1] + y)*extents[2] + z] != expected;
+	  }
+
+      BOOST_CHECK_MESSAGE(mismatches == 0, "kernel " << k << " level " << l << " mismatches " << mismatches);
+
+      previous = levels[l].data_;
+      previous_extents.assign(extents, extents + 3);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MPI_CONVOLUTION
+#include "boost/test/unit_test.hpp"
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "anyfold.hpp"
+#include "mpi/convolve.hpp"
+
+#include "test_algorithms.hpp"
+#include "image_stack_utils.h"
+
+struct mpi_environment {
+  mpi_environment()  { MPI_Init(0, 0); }
+  ~mpi_environment() { MPI_Finalize(); }
+};
+
+BOOST_GLOBAL_FIXTURE( mpi_environment );
+
+struct distributedFixture {
+
+  int rank_;
+  int size_;
+
+  distributedFixture():
+    rank_(0),
+    size_(1)
+  {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+    MPI_Comm_size(MPI_COMM_WORLD, &size_);
+  }
+
+  //runs the distributed convolution and compares the local slab with convolve_3d on the whole image
+  float l2norm_to_serial(std::vector<long> global_shape, std::vector<long> kernel_shape, bool uniform = false){
+
+    std::vector<float> image(global_shape[0]*global_shape[1]*global_shape[2]);
+    for(unsigned p = 0;p<image.size();++p)
+      image[p] = float((p*13) % 23);
+
+    std::vector<float> kernel(kernel_shape[0]*kernel_shape[1]*kernel_shape[2]);
+    for(unsigned p = 0;p<kernel.size();++p)
+      kernel[p] = uniform ? .25f : float(p % 5) - 1.f;
+
+    std::vector<float> expected(image.size(), 0.f);
+    anyfold::cpu::convolve_3d(&image[0], &global_shape[0],
+			      &kernel[0], &kernel_shape[0],
+			      &expected[0]);
+
+    long first_plane = 0;
+    std::vector<long> local_shape(global_shape);
+    anyfold::mpi::slab(global_shape[0], rank_, size_, first_plane, local_shape[0]);
+
+    const long frame_size = global_shape[1]*global_shape[2];
+    std::vector<float> local_output(local_shape[0]*frame_size, 0.f);
+
+    anyfold::mpi::convolve_3d(MPI_COMM_WORLD,
+			      &image[first_plane*frame_size], &local_shape[0],
+			      &kernel[0], &kernel_shape[0],
+			      local_output.begin());
+
+    return anyfold::l2norm(&local_output[0], &expected[first_plane*frame_size], local_output.size());
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE( distributed_convolution_works, distributedFixture )
+
+BOOST_AUTO_TEST_CASE( slabs_cover_all_planes )
+{
+  long covered = 0;
+  for(int r = 0;r<5;++r){
+    long first = 0;
+    long planes = 0;
+    anyfold::mpi::slab(17L, r, 5, first, planes);
+    BOOST_CHECK_EQUAL(first, covered);
+    BOOST_CHECK(planes == 3 || planes == 4);
+    covered += planes;
+  }
+  BOOST_CHECK_EQUAL(covered, 17);
+}
+
+BOOST_AUTO_TEST_CASE( matches_serial_convolution )
+{
+  std::vector<long> global_shape(3);
+  global_shape[0] = 6*size_ + 1; global_shape[1] = 9; global_shape[2] = 11;
+
+  std::vector<long> kernel_shape(3,5);
+  BOOST_CHECK_SMALL(l2norm_to_serial(global_shape, kernel_shape), 1e-4f);
+
+  kernel_shape[0] = 3; kernel_shape[1] = 7; kernel_shape[2] = 1;
+  BOOST_CHECK_SMALL(l2norm_to_serial(global_shape, kernel_shape), 1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE( uniform_kernels_match_serial_convolution )
+{
+  //long enough slabs for several box filter chunks per rank
+  std::vector<long> global_shape(3);
+  global_shape[0] = 40*size_ + 3; global_shape[1] = 9; global_shape[2] = 11;
+
+  std::vector<long> kernel_shape(3,3);
+  BOOST_CHECK_SMALL(l2norm_to_serial(global_shape, kernel_shape, true), 1e-4f);
+
+  kernel_shape[0] = 4; kernel_shape[1] = 5; kernel_shape[2] = 1;
+  BOOST_CHECK_SMALL(l2norm_to_serial(global_shape, kernel_shape, true), 1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE( thin_slabs_throw_on_all_ranks )
+{
+  if(size_ < 2)
+    return;
+
+  std::vector<long> global_shape(3,8);
+  global_shape[0] = size_;
+  std::vector<long> kernel_shape(3,5);
+
+  BOOST_CHECK_THROW(l2norm_to_serial(global_shape, kernel_shape), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
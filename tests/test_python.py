@@ -0,0 +1,132 @@
+"""tests of the anyfold python bindings, expects the extension module on PYTHONPATH"""
+import array
+import threading
+import unittest
+
+import anyfold
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+def volume(typecode, shape, values):
+    """3 dimensional, C contiguous memoryview holding values"""
+    return memoryview(array.array(typecode, values)).cast('B').cast(typecode, list(shape))
+
+
+def reference(image, shape, kernel, kshape):
+    """plain python convolution of the valid region (flat lists, C order)"""
+    n0, n1, n2 = shape
+    k0, k1, k2 = kshape
+    out = {}
+    for x in range(k0 // 2, n0 - k0 // 2):
+        for y in range(k1 // 2, n1 - k1 // 2):
+            for z in range(k2 // 2, n2 - k2 // 2):
+                value = 0.
+                for i in range(k0):
+                    for j in range(k1):
+                        for k in range(k2):
+                            src = ((x + k0 // 2 - i) * n1 + (y + k1 // 2 - j)) * n2 + (z + k2 // 2 - k)
+                            value += image[src] * kernel[(i * k1 + j) * k2 + k]
+                out[(x * n1 + y) * n2 + z] = value
+    return out
+
+
+class ConvolutionTest(unittest.TestCase):
+
+    shape = (7, 8, 9)
+    kshape = (3, 3, 3)
+
+    def setUp(self):
+        size = self.shape[0] * self.shape[1] * self.shape[2]
+        self.image = [float((p * 13) % 23) for p in range(size)]
+        self.kernel = [float(p % 5) - 1. for p in range(27)]
+        self.expected = reference(self.image, self.shape, self.kernel, self.kshape)
+
+    def check(self, out, flat=None):
+        flat = flat if flat is not None else out.cast('B').cast(out.format).tolist()
+        for index, value in self.expected.items():
+            self.assertAlmostEqual(flat[index], value, places=3)
+
+    def test_active_isa(self):
+        self.assertIn(anyfold.active_isa(), ('generic', 'sse42', 'avx2', 'avx512'))
+
+    def test_memoryview_float32(self):
+        src = volume('f', self.shape, self.image)
+        kernel = volume('f', self.kshape, self.kernel)
+        out = volume('f', self.shape, [0.] * len(self.image))
+        self.assertIs(anyfold.convolve_3d(src, kernel, out), out)
+        self.check(out)
+
+    def test_memoryview_uint16(self):
+        src = volume('H', self.shape, [int(v) for v in self.image])
+        kernel = volume('f', self.kshape, self.kernel)
+        out = volume('f', self.shape, [0.] * len(self.image))
+        anyfold.convolve_3d(src=src, kernel=kernel, out=out)
+        self.check(out)
+
+    def test_errors(self):
+        src = volume('f', self.shape, self.image)
+        kernel = volume('f', self.kshape, self.kernel)
+        out = volume('f', self.shape, [0.] * len(self.image))
+        flat = memoryview(array.array('f', self.image))
+        with self.assertRaises(ValueError):
+            anyfold.convolve_3d(flat, kernel, out)
+        with self.assertRaises(TypeError):
+            anyfold.convolve_3d(volume('d', self.shape, self.image), kernel, out)
+        with self.assertRaises(BufferError):
+            anyfold.convolve_3d(src, kernel, out.toreadonly())
+        with self.assertRaises(ValueError):
+            anyfold.convolve_3d(src, kernel, volume('f', (9, 8, 7), self.image))
+
+        # out must not share memory with src or kernel
+        with self.assertRaises(ValueError):
+            anyfold.convolve_3d(src, kernel, src)
+        shared = memoryview(array.array('f', self.image + self.kernel))
+        shared_kernel = shared[len(self.image):].cast('B').cast('f', list(self.kshape))
+        with self.assertRaises(ValueError):
+            anyfold.convolve_3d(src, shared_kernel, shared[len(self.kernel):].cast('B').cast('f', list(self.shape)))
+        # adjacent, but disjoint buffers are fine
+        out = shared[:len(self.image)].cast('B').cast('f', list(self.shape))
+        anyfold.convolve_3d(src, shared_kernel, out)
+        self.check(out)
+
+    def test_import_keeps_subnormals(self):
+        # a module linked with -ffast-math would enable flush-to-zero for the interpreter
+        tiny = float.fromhex('0x1p-1070')
+        self.assertNotEqual(tiny * 1.0, 0.0)
+
+    def test_threads(self):
+        src = volume('f', self.shape, self.image)
+        kernel = volume('f', self.kshape, self.kernel)
+        outputs = [volume('f', self.shape, [0.] * len(self.image)) for _ in range(4)]
+        threads = [threading.Thread(target=anyfold.convolve_3d, args=(src, kernel, out)) for out in outputs]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for out in outputs:
+            self.check(out)
+
+    @unittest.skipIf(numpy is None, "numpy not available")
+    def test_numpy_views(self):
+        image = numpy.array(self.image, dtype=numpy.float32).reshape(self.shape)
+        kernel = numpy.array(self.kernel, dtype=numpy.float32).reshape(self.kshape)
+
+        # transposed input and output are passed by their strides, not copied
+        out = numpy.zeros(self.shape[::-1], dtype=numpy.float32)
+        anyfold.convolve_3d(numpy.ascontiguousarray(image.T).T, kernel, out.T)
+        self.check(None, out.T.ravel().tolist())
+
+        # a sliced view writes into its parent
+        parent = numpy.zeros((self.shape[0] + 2, self.shape[1], self.shape[2] + 4), dtype=numpy.float32)
+        view = parent[1:-1, :, 2:-2]
+        anyfold.convolve_3d(image, kernel, view)
+        self.check(None, view.ravel().tolist())
+        self.assertEqual(parent[0].sum(), 0.)
+
+
+if __name__ == '__main__':
+    unittest.main()